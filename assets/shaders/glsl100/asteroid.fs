@@ -0,0 +1,35 @@
+#version 100
+
+// For fwidth()
+#extension GL_OES_standard_derivatives : enable
+
+precision mediump float;
+
+// Input vertex attributes (from vertex shader)
+varying vec4 fragColor;
+varying vec3 fragNormal;
+varying vec2 fragBarycentric;
+
+// Input uniform values
+uniform vec4 colDiffuse;
+uniform vec4 wireColor;
+
+const vec3 lightDirection = vec3(0.48, 0.64, 0.6);
+const float ambient = 0.45;
+// Edge lines are about this many pixels wide, whatever the distance.
+const float wireWidth = 1.0;
+
+void main()
+{
+    float light = ambient + (1.0 - ambient)*max(dot(normalize(fragNormal), lightDirection), 0.0);
+    vec4 color = colDiffuse*fragColor;
+
+    // Near an edge one of the barycentric coordinates goes to zero. Measuring that in pixels
+    // gives lines that stay the same width and are anti-aliased.
+    vec3 barycentric = vec3(fragBarycentric, 1.0 - fragBarycentric.x - fragBarycentric.y);
+    vec3 edges = smoothstep(vec3(0.0), fwidth(barycentric)*wireWidth, barycentric);
+    float wire = 1.0 - min(min(edges.x, edges.y), edges.z);
+    color = mix(color, wireColor, wire);
+
+    gl_FragColor = vec4(color.rgb*light, color.a);
+}
@@ -0,0 +1,82 @@
+#version 100
+
+// Input vertex attributes
+attribute vec3 vertexPosition;
+attribute vec4 vertexColor;
+// Barycentric coordinates of the vertex in its triangle, baked in at load. The third is 1 - x - y.
+attribute vec2 vertexTexCoord2;
+
+// Input uniform values
+uniform mat4 mvp;
+uniform mat4 matModel;
+uniform mat4 matNormal;
+
+// Each asteroid gets its own shape from this. Must match shapeScale() in Asteroid.cpp.
+uniform float shapeSeed;
+
+// Output vertex attributes (to fragment shader)
+varying vec4 fragColor;
+varying vec3 fragNormal;
+varying vec2 fragBarycentric;
+
+const float amplitude = 0.35;
+const float frequency = 2.5;
+
+// Hash without sine, so it gives the same results on every GPU.
+float hash13(vec3 p3)
+{
+    p3 = fract(p3*0.1031);
+    p3 += dot(p3, p3.zyx + 31.32);
+    return fract((p3.x + p3.y)*p3.z);
+}
+
+// Value noise in [-1, 1]
+float noise(vec3 p)
+{
+    vec3 i = floor(p);
+    vec3 f = fract(p);
+    f = f*f*(3.0 - 2.0*f);
+
+    float n000 = hash13(i);
+    float n100 = hash13(i + vec3(1.0, 0.0, 0.0));
+    float n010 = hash13(i + vec3(0.0, 1.0, 0.0));
+    float n110 = hash13(i + vec3(1.0, 1.0, 0.0));
+    float n001 = hash13(i + vec3(0.0, 0.0, 1.0));
+    float n101 = hash13(i + vec3(1.0, 0.0, 1.0));
+    float n011 = hash13(i + vec3(0.0, 1.0, 1.0));
+    float n111 = hash13(i + vec3(1.0, 1.0, 1.0));
+
+    float n = mix(mix(mix(n000, n100, f.x), mix(n010, n110, f.x), f.y),
+                  mix(mix(n001, n101, f.x), mix(n011, n111, f.x), f.y), f.z);
+    return n*2.0 - 1.0;
+}
+
+// Pushes a point in or out along its direction from the center. Vertices that share a position
+// get the same offset, so the mesh never cracks.
+vec3 displace(vec3 position)
+{
+    vec3 direction = normalize(position);
+    vec3 offset = vec3(shapeSeed*0.618, shapeSeed*0.382 + 17.0, shapeSeed*0.277 + 41.0);
+    return position*(1.0 + amplitude*noise(direction*frequency + offset));
+}
+
+void main()
+{
+    vec3 position = displace(vertexPosition);
+
+    // Normal of the displaced surface, from two nearby points on it.
+    vec3 direction = normalize(vertexPosition);
+    vec3 tangent = normalize(cross(direction, abs(direction.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+    vec3 bitangent = cross(direction, tangent);
+    float delta = 0.01*length(vertexPosition);
+    vec3 normal = normalize(cross(displace(vertexPosition + tangent*delta) - position,
+                                  displace(vertexPosition + bitangent*delta) - position));
+    if (dot(normal, direction) < 0.0) normal = -normal;
+
+    fragColor = vertexColor;
+    fragBarycentric = vertexTexCoord2;
+    fragNormal = normalize(vec3(matNormal*vec4(normal, 0.0)));
+
+    // Calculate final vertex position
+    gl_Position = mvp*vec4(position, 1.0);
+}
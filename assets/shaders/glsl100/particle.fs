@@ -0,0 +1,15 @@
+#version 100
+
+precision mediump float;
+
+// Input vertex attributes (from vertex shader)
+varying vec2 fragCorner;
+varying vec4 fragColor;
+
+void main()
+{
+    // A soft round dot rather than a square.
+    float falloff = max(1.0 - dot(fragCorner, fragCorner), 0.0);
+
+    gl_FragColor = vec4(fragColor.rgb, fragColor.a*falloff);
+}
@@ -0,0 +1,33 @@
+#version 100
+
+// Input vertex attributes. The corner is per vertex, the rest per particle.
+attribute vec2 quadCorner;
+attribute float particleX;
+attribute float particleY;
+attribute float particleZ;
+attribute float particleFade;
+attribute vec4 particleColor;
+
+// Input uniform values
+uniform mat4 matView;
+uniform mat4 matProjection;
+uniform float particleSize;
+
+// Output vertex attributes (to fragment shader)
+varying vec2 fragCorner;
+varying vec4 fragColor;
+
+void main()
+{
+    float fade = clamp(particleFade, 0.0, 1.0);
+
+    // The quad is built in view space so it always faces the camera. It shrinks as it fades.
+    vec4 center = matView*vec4(particleX, particleY, particleZ, 1.0);
+    center.xy += quadCorner*particleSize*(0.3 + 0.7*fade);
+
+    // Fresh particles burn white hot and cool to their own color.
+    fragCorner = quadCorner;
+    fragColor = vec4(mix(particleColor.rgb, vec3(1.0), fade*fade*0.6), particleColor.a*fade);
+
+    gl_Position = matProjection*center;
+}
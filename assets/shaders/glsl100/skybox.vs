@@ -19,6 +19,7 @@ void main()
     mat4 rotView = mat4(mat3(matView));
     vec4 clipPos = matProjection*rotView*vec4(vertexPosition, 1.0);
 
-    // Calculate final vertex position
-    gl_Position = clipPos;
+    // Calculate final vertex position. Depth is forced to the far plane so the skybox only
+    // shades pixels that nothing else has covered.
+    gl_Position = clipPos.xyww;
 }
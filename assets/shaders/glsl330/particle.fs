@@ -0,0 +1,16 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragCorner;
+in vec4 fragColor;
+
+// Output fragment color
+out vec4 finalColor;
+
+void main()
+{
+    // A soft round dot rather than a square.
+    float falloff = max(1.0 - dot(fragCorner, fragCorner), 0.0);
+
+    finalColor = vec4(fragColor.rgb, fragColor.a*falloff);
+}
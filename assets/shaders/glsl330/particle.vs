@@ -0,0 +1,33 @@
+#version 330
+
+// Input vertex attributes. The corner is per vertex, the rest per particle.
+in vec2 quadCorner;
+in float particleX;
+in float particleY;
+in float particleZ;
+in float particleFade;
+in vec4 particleColor;
+
+// Input uniform values
+uniform mat4 matView;
+uniform mat4 matProjection;
+uniform float particleSize;
+
+// Output vertex attributes (to fragment shader)
+out vec2 fragCorner;
+out vec4 fragColor;
+
+void main()
+{
+    float fade = clamp(particleFade, 0.0, 1.0);
+
+    // The quad is built in view space so it always faces the camera. It shrinks as it fades.
+    vec4 center = matView*vec4(particleX, particleY, particleZ, 1.0);
+    center.xy += quadCorner*particleSize*(0.3 + 0.7*fade);
+
+    // Fresh particles burn white hot and cool to their own color.
+    fragCorner = quadCorner;
+    fragColor = vec4(mix(particleColor.rgb, vec3(1.0), fade*fade*0.6), particleColor.a*fade);
+
+    gl_Position = matProjection*center;
+}
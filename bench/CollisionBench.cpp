@@ -0,0 +1,142 @@
+// Measures how many ship (sphere) and bullet (segment) queries per second the asteroid collision
+// tests can answer, against the shape the shader draws and against the plain collision sphere.
+// Runs on the CPU only, so it doesn't need a window.
+//
+// Usage: CollisionBench [--asteroids 200] [--queries 200000]
+
+#include "../libs/raylib/src/raylib.h"
+#include "../libs/raylib/src/raymath.h"
+
+#include "../src/Asteroid.hpp"
+#include "../src/MeshBvh.hpp"
+#include "../src/Random.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// The mesh of assets/asteroid.gltf. Loading the file would need a GL context.
+static float asteroidVertices[] = {
+     0.0000f, -0.5000f,  0.0000f,
+     0.4633f, -0.2864f,  0.3366f,
+    -0.1531f, -0.2477f,  0.4711f,
+    -0.9560f, -0.4780f,  0.0000f,
+    -0.1696f, -0.2744f, -0.5219f,
+     0.3618f, -0.2236f, -0.2629f,
+     0.1382f,  0.2236f,  0.4253f,
+    -0.4321f,  0.2671f,  0.3139f,
+    -0.4825f,  0.2982f, -0.3506f,
+     0.2172f,  0.3514f, -0.6685f,
+     0.4472f,  0.2236f,  0.0000f,
+     0.0000f,  0.5764f,  0.0000f,
+};
+
+static unsigned short asteroidIndices[] = {
+    0, 1, 2,   1, 0, 5,   0, 2, 3,   0, 3, 4,   0, 4, 5,
+    1, 5, 10,  2, 1, 6,   3, 2, 7,   4, 3, 8,   5, 4, 9,
+    1, 10, 6,  2, 6, 7,   3, 7, 8,   4, 8, 9,   5, 9, 10,
+    6, 10, 11, 7, 6, 11,  8, 7, 11,  9, 8, 11,  10, 9, 11,
+};
+
+static const float FieldSize = 100;
+static const float ShipRadius = 0.5f;
+// How far a bullet moves in a 60 Hz tick.
+static const float BulletStep = 100.0f / 60;
+
+static Vector3 randomPoint(Random& random, float min, float max) {
+    return { random.rangeFloat(min, max), random.rangeFloat(min, max), random.rangeFloat(min, max) };
+}
+
+// Runs `queries` sphere and segment queries against every asteroid and prints the rates.
+static void run(const char* name, const MeshBvh* bvh, const std::vector<Asteroid>& asteroids, int queries) {
+    typedef std::chrono::steady_clock Clock;
+
+    // Queries are clustered around the asteroids so plenty of them get past the early-out.
+    Random random(1234);
+    std::vector<Vector3> points(queries);
+    std::vector<Vector3> ends(queries);
+    for (int i = 0; i < queries; ++i) {
+        const Asteroid& near = asteroids[random.range(0, (int)asteroids.size() - 1)];
+        points[i] = Vector3Add(near.position, randomPoint(random, -4, 4));
+        Vector3 direction = Vector3Normalize(randomPoint(random, -1, 1));
+        ends[i] = Vector3Add(points[i], Vector3Scale(direction, BulletStep));
+    }
+
+    int sphereHits = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < queries; ++i) {
+        for (auto& asteroid : asteroids) {
+            if (asteroid.isHitBySphere(bvh, points[i], ShipRadius)) {
+                sphereHits++;
+                break;
+            }
+        }
+    }
+    double sphereSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    int segmentHits = 0;
+    start = Clock::now();
+    for (int i = 0; i < queries; ++i) {
+        for (auto& asteroid : asteroids) {
+            if (asteroid.isHitBySegment(bvh, points[i], ends[i])) {
+                segmentHits++;
+                break;
+            }
+        }
+    }
+    double segmentSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    printf("%-8s  sphere %10.0f queries/s (%5.1f%% hit)  segment %10.0f queries/s (%5.1f%% hit)\n",
+           name,
+           queries / sphereSeconds, 100.0 * sphereHits / queries,
+           queries / segmentSeconds, 100.0 * segmentHits / queries);
+}
+
+int main(int argc, char** argv) {
+    int asteroidCount = 200;
+    int queries = 200000;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--asteroids") == 0 && i + 1 < argc) {
+            asteroidCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--queries") == 0 && i + 1 < argc) {
+            queries = atoi(argv[++i]);
+        } else {
+            printf("Usage: %s [--asteroids 200] [--queries 200000]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (asteroidCount < 1 || queries < 1) {
+        printf("--asteroids and --queries must be at least 1\n");
+        return 1;
+    }
+
+    Mesh mesh = { 0 };
+    mesh.vertexCount = sizeof(asteroidVertices) / sizeof(float) / 3;
+    mesh.triangleCount = sizeof(asteroidIndices) / sizeof(unsigned short) / 3;
+    mesh.vertices = asteroidVertices;
+    mesh.indices = asteroidIndices;
+
+    auto start = std::chrono::steady_clock::now();
+    MeshBvh bvh(mesh);
+    double buildMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    printf("BVH of %d triangles built in %.1f us\n", bvh.getTriangleCount(), buildMicroseconds);
+
+    Random random(42);
+    std::vector<Asteroid> asteroids;
+    for (int i = 0; i < asteroidCount; ++i) {
+        Vector3 rotation = randomPoint(random, 1, 7);
+        Asteroid asteroid(Model(), randomPoint(random, 0, FieldSize), Vector3Zero(), rotation,
+                          random.range(0, AsteroidShapeSeeds - 1));
+        asteroid.scale = random.rangeFloat(1, 3);
+        asteroids.push_back(asteroid);
+    }
+
+    printf("%d asteroids, %d queries each against all of them\n", asteroidCount, queries);
+    run("radius", nullptr, asteroids, queries);
+    run("mesh", &bvh, asteroids, queries);
+    return 0;
+}
@@ -0,0 +1,131 @@
+// Times EnemyGunnery::aim() for a big fleet against solving each enemy's intercept one at a time
+// with raymath, and checks the batched solve: every bullet has to fly at the bullet speed and
+// meet the target where it will be. Exits with 1 if any shot misses by more than the tolerance,
+// so it can run in CI.
+//
+// Usage: GunneryBench [--enemies 1000] [--ticks 600]
+
+#include "../libs/raylib/src/raylib.h"
+#include "../libs/raylib/src/raymath.h"
+
+#include "../src/EnemyGunnery.hpp"
+#include "../src/Ship.hpp"
+#include "../src/Random.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static const float TickStep = 1.0f / 60;
+// Relative to how far the bullet flies.
+static const float MissTolerance = 1e-5f;
+
+typedef std::chrono::steady_clock Clock;
+
+static Vector3 randomVector(Random& random, float extent) {
+    return { random.rangeFloat(-extent, extent), random.rangeFloat(-extent, extent),
+             random.rangeFloat(-extent, extent) };
+}
+
+// The textbook way, for comparison: the smaller positive root of the quadratic, per enemy.
+static float solveIntercept(Vector3 offset, Vector3 velocity, float speed) {
+    float a = Vector3DotProduct(velocity, velocity) - speed * speed;
+    float b = 2 * Vector3DotProduct(offset, velocity);
+    float c = Vector3DotProduct(offset, offset);
+    float discriminant = b * b - 4 * a * c;
+    if (discriminant < 0 || fabsf(a) < 1e-6f)
+        return -1;
+
+    float root = sqrtf(discriminant);
+    float first = (-b + root) / (2 * a);
+    float second = (-b - root) / (2 * a);
+    if (first > 0 && (second <= 0 || first < second))
+        return first;
+    return second > 0 ? second : -1;
+}
+
+int main(int argc, char** argv) {
+    int enemyCount = 1000;
+    int tickCount = 600;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--enemies") == 0 && i + 1 < argc) {
+            enemyCount = std::max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            tickCount = std::max(atoi(argv[++i]), 1);
+        } else {
+            printf("Usage: %s [--enemies 1000] [--ticks 600]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // A fleet all around the target, facing every way.
+    Random random(1);
+    Ship target(Model{}, false);
+    target.velocity = randomVector(random, 30);
+
+    std::vector<Ship> enemies(enemyCount, Ship(Model{}, true));
+    for (auto &enemy : enemies) {
+        enemy.position = randomVector(random, 60);
+        enemy.rotation = QuaternionFromEuler(random.rangeFloat(-PI, PI), random.rangeFloat(-PI, PI), 0);
+    }
+
+    EnemyGunnery gunnery(enemyCount);
+    double batchSeconds = 0;
+    double scalarSeconds = 0;
+    float worstMiss = 0;
+    long shots = 0;
+    float sink = 0;
+
+    for (int tick = 0; tick < tickCount; ++tick) {
+        target.position = Vector3Add(target.position, Vector3Scale(target.velocity, TickStep));
+
+        Clock::time_point start = Clock::now();
+        gunnery.aim(enemies, target);
+        Clock::time_point aimed = Clock::now();
+
+        // Same inputs, one enemy at a time.
+        for (auto &enemy : enemies) {
+            float time = solveIntercept(Vector3Subtract(target.position, enemy.position), target.velocity,
+                                        gunnery.bulletSpeed);
+            sink += time + Vector3DotProduct(enemy.getForward(), target.velocity) * 1e-9f;
+        }
+        Clock::time_point solved = Clock::now();
+
+        batchSeconds += std::chrono::duration<double>(aimed - start).count();
+        scalarSeconds += std::chrono::duration<double>(solved - aimed).count();
+
+        // Each bullet has to be where the target is after the reference flight time. Checked for
+        // every enemy, not just the ones with the target in their cone.
+        for (int i = 0; i < enemyCount; ++i) {
+            Vector3 offset = Vector3Subtract(target.position, enemies[i].position);
+            float time = solveIntercept(offset, target.velocity, gunnery.bulletSpeed);
+            Vector3 bullet = Vector3Scale(gunnery.getBulletVelocity(i), time);
+            Vector3 meeting = Vector3Add(offset, Vector3Scale(target.velocity, time));
+            worstMiss = fmaxf(worstMiss, Vector3Distance(bullet, meeting) / (gunnery.bulletSpeed * time));
+
+            if (gunnery.hasShot(i))
+                shots++;
+        }
+    }
+
+    bool passed = worstMiss <= MissTolerance;
+    printf("%d enemies, %d ticks, %.1f%% had a shot each tick\n", enemyCount, tickCount,
+           100.0 * shots / ((double)enemyCount * tickCount));
+    printf("aim ns per enemy: batched %.2f   one at a time %.2f   %.2fx\n",
+           batchSeconds * 1e9 / ((double)enemyCount * tickCount),
+           scalarSeconds * 1e9 / ((double)enemyCount * tickCount), scalarSeconds / batchSeconds);
+    printf("aim ms per tick: %.4f\n", batchSeconds * 1000 / tickCount);
+    printf("worst miss %.3g of the distance flown (bound %.3g) %s\n",
+           worstMiss, MissTolerance, passed ? "ok" : "FAIL");
+
+    // Keeps the comparison loop from being optimized away.
+    if (sink == 12345)
+        printf("\n");
+
+    return passed ? 0 : 1;
+}
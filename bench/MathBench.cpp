@@ -0,0 +1,154 @@
+// Checks the SIMD math in SimdMath.hpp against raymath and expf, and compares their speed. Exits
+// with 1 if any result is further off than the documented bound, so it can run in CI.
+//
+// Usage: MathBench [--count 1000000]
+
+#include "../libs/raylib/src/raylib.h"
+#include "../libs/raylib/src/raymath.h"
+
+#include "../src/SimdMath.hpp"
+#include "../src/Random.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Rotations and products of unit quaternions come out around 1, so these are absolute.
+static const float RotateTolerance = 1e-5f;
+static const float MultiplyTolerance = 1e-6f;
+// Relative, as documented on fastExp().
+static const float ExpTolerance = 2e-5f;
+// Relative error of 1 - fastExp(x), the damping factor smoothDamp() uses, for x from -0.001 to -1.
+// Part of it is the float rounding of results just under 1.
+static const float DampingTolerance = 1e-4f;
+
+typedef std::chrono::steady_clock Clock;
+
+static Quaternion randomRotation(Random& random) {
+    Vector3 axis = { random.rangeFloat(-1, 1), random.rangeFloat(-1, 1), random.rangeFloat(-1, 1) };
+    if (Vector3Length(axis) < 0.001f)
+        axis = { 0, 1, 0 };
+    return QuaternionFromAxisAngle(axis, random.rangeFloat(-PI, PI));
+}
+
+static float maxDifference(Vector3 a, Vector3 b) {
+    return fmaxf(fabsf(a.x - b.x), fmaxf(fabsf(a.y - b.y), fabsf(a.z - b.z)));
+}
+
+static float maxDifference(Quaternion a, Quaternion b) {
+    return fmaxf(fmaxf(fabsf(a.x - b.x), fabsf(a.y - b.y)), fmaxf(fabsf(a.z - b.z), fabsf(a.w - b.w)));
+}
+
+static double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static bool report(const char* name, float error, float tolerance, double raylibTime, double simdTime) {
+    bool passed = error <= tolerance;
+    printf("%-9s max error %.3g (bound %.3g) %s   raymath %.2f ns   simd %.2f ns   %.2fx\n",
+            name, error, tolerance, passed ? "ok  " : "FAIL",
+            raylibTime, simdTime, raylibTime / simdTime);
+    return passed;
+}
+
+int main(int argc, char** argv) {
+    int count = 1000000;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = atoi(argv[++i]);
+        } else {
+            printf("Usage: %s [--count 1000000]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    Random random(1234);
+    std::vector<Quaternion> rotations(count);
+    std::vector<Quaternion> others(count);
+    std::vector<Vector3> vectors(count);
+    std::vector<float> exponents(count);
+
+    for (int i = 0; i < count; ++i) {
+        rotations[i] = randomRotation(random);
+        others[i] = randomRotation(random);
+        vectors[i] = { random.rangeFloat(-1, 1), random.rangeFloat(-1, 1), random.rangeFloat(-1, 1) };
+        // Mostly the small negative exponents smoothDamp() uses, with the rest spread over the range.
+        exponents[i] = i % 4 == 0 ? random.rangeFloat(-87, 88) : random.rangeFloat(-10, 0);
+    }
+
+    printf("SIMD path: %s, %d samples\n", HYPERSONIC_SSE ? "SSE2" : "scalar", count);
+
+    std::vector<Vector3> expectedVectors(count);
+    std::vector<Vector3> actualVectors(count);
+    std::vector<Quaternion> expectedProducts(count);
+    std::vector<Quaternion> actualProducts(count);
+    std::vector<float> expectedExps(count);
+    std::vector<float> actualExps(count);
+
+    // Each is timed over the whole batch, with results written out so the work can't be skipped.
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < count; ++i)
+        expectedVectors[i] = Vector3RotateByQuaternion(vectors[i], rotations[i]);
+    double raylibRotate = secondsSince(start);
+
+    start = Clock::now();
+    for (int i = 0; i < count; ++i)
+        actualVectors[i] = rotateVector(rotations[i], vectors[i]);
+    double simdRotate = secondsSince(start);
+
+    start = Clock::now();
+    for (int i = 0; i < count; ++i)
+        expectedProducts[i] = QuaternionMultiply(rotations[i], others[i]);
+    double raylibMultiply = secondsSince(start);
+
+    start = Clock::now();
+    for (int i = 0; i < count; ++i)
+        actualProducts[i] = multiplyQuaternions(rotations[i], others[i]);
+    double simdMultiply = secondsSince(start);
+
+    start = Clock::now();
+    for (int i = 0; i < count; ++i)
+        expectedExps[i] = expf(exponents[i]);
+    double libraryExp = secondsSince(start);
+
+    start = Clock::now();
+    for (int i = 0; i < count; ++i)
+        actualExps[i] = fastExp(exponents[i]);
+    double simdExp = secondsSince(start);
+
+    float rotateError = 0;
+    float multiplyError = 0;
+    float expError = 0;
+    for (int i = 0; i < count; ++i) {
+        rotateError = fmaxf(rotateError, maxDifference(expectedVectors[i], actualVectors[i]));
+        multiplyError = fmaxf(multiplyError, maxDifference(expectedProducts[i], actualProducts[i]));
+        // Compared against double precision, so expf's own rounding doesn't count against it.
+        double exact = exp((double)exponents[i]);
+        expError = fmaxf(expError, (float)(fabs(actualExps[i] - exact) / exact));
+    }
+
+    double perCall = 1e9 / count;
+    bool passed = true;
+    passed &= report("rotate", rotateError, RotateTolerance, raylibRotate * perCall, simdRotate * perCall);
+    passed &= report("multiply", multiplyError, MultiplyTolerance, raylibMultiply * perCall, simdMultiply * perCall);
+    passed &= report("exp", expError, ExpTolerance, libraryExp * perCall, simdExp * perCall);
+
+    // A tiny error in e^x near 1 is a big one in 1 - e^x, so damping is checked on its own,
+    // against -expm1(x) in double precision. No time at all has to give no damping at all.
+    float dampingError = 0;
+    for (int i = 0; i <= 1000; ++i) {
+        float x = -powf(10, -3 + 3 * i / 1000.0f);
+        double exact = -expm1((double)x);
+        dampingError = fmaxf(dampingError, (float)(fabs((1 - fastExp(x)) - exact) / exact));
+    }
+    bool dampingPassed = dampingError <= DampingTolerance && fastExp(0) == 1;
+    printf("%-9s max error %.3g (bound %.3g) %s   fastExp(0) %s\n", "damping", dampingError, DampingTolerance,
+           dampingPassed ? "ok  " : "FAIL", fastExp(0) == 1 ? "is 1" : "is not 1");
+    passed &= dampingPassed;
+
+    return passed ? 0 : 1;
+}
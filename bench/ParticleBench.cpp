@@ -0,0 +1,80 @@
+// Measures how long ParticleSystem::update() takes with a full pool of particles, against the
+// 1 ms a frame the effects are budgeted. Particles keep dying and being replaced by new bursts,
+// like in a big fight, so removal is measured too. Runs on the CPU only, so it doesn't need a
+// window.
+//
+// Usage: ParticleBench [--particles 100000] [--frames 600]
+
+#include "../libs/raylib/src/raylib.h"
+
+#include "../src/ParticleSystem.hpp"
+#include "../src/Random.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static const float FrameStep = 1.0f / 60;
+static const float BudgetMilliseconds = 1;
+
+int main(int argc, char** argv) {
+    int particleCount = 100000;
+    int frameCount = 600;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--particles") == 0 && i + 1 < argc) {
+            particleCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frameCount = std::max(atoi(argv[++i]), 1);
+        } else {
+            printf("Usage: %s [--particles 100000] [--frames 600]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    typedef std::chrono::steady_clock Clock;
+
+    ParticleSystem particles(particleCount);
+    Random random(1);
+    std::vector<float> updateTimes;
+    std::vector<float> emitTimes;
+    updateTimes.reserve(frameCount);
+    emitTimes.reserve(frameCount);
+
+    for (int frame = 0; frame < frameCount; ++frame) {
+        // Top the pool up with bursts in random places.
+        Clock::time_point start = Clock::now();
+        while (particles.getCount() + 1000 <= particleCount) {
+            Vector3 position = { (float)random.range(-100, 100), (float)random.range(-100, 100),
+                                 (float)random.range(-100, 100) };
+            particles.emitBurst(position, { 0, 0, 5 }, 1000, 10, 1.5f, ORANGE);
+        }
+        Clock::time_point emitted = Clock::now();
+
+        particles.update(FrameStep);
+        Clock::time_point updated = Clock::now();
+
+        emitTimes.push_back(std::chrono::duration<float>(emitted - start).count() * 1000);
+        updateTimes.push_back(std::chrono::duration<float>(updated - emitted).count() * 1000);
+    }
+
+    std::sort(updateTimes.begin(), updateTimes.end());
+    float total = 0;
+    for (float time : updateTimes)
+        total += time;
+    float emitTotal = 0;
+    for (float time : emitTimes)
+        emitTotal += time;
+
+    float p95 = updateTimes[std::min((size_t)(updateTimes.size() * 0.95f), updateTimes.size() - 1)];
+    printf("%d particles (%d live at the end), %d frames\n", particleCount, particles.getCount(), frameCount);
+    printf("update ms: avg %.3f  p50 %.3f  p95 %.3f  max %.3f  (budget %.1f)\n",
+           total / frameCount, updateTimes[updateTimes.size() / 2], p95, updateTimes.back(), BudgetMilliseconds);
+    printf("emit ms: avg %.3f\n", emitTotal / frameCount);
+    printf("%s\n", p95 <= BudgetMilliseconds ? "within budget" : "OVER BUDGET");
+
+    return 0;
+}
@@ -0,0 +1,319 @@
+// Renders a scripted scene into an offscreen render target the way the game does, as fast as it
+// can, and prints how long the CPU takes to submit each frame, the draw calls, and the frame
+// rate. With --views the target is split like in split screen, and the work the views share is
+// timed apart from each view's own. The window stays hidden and vsync is off. Without a GPU, like on CI, run it with
+// --software under a virtual display to use Mesa's llvmpipe:
+//
+//     xvfb-run ./RenderBench --software --png frame.png
+//
+// Runs from the repository root, like the game, so it can find the assets.
+//
+// Usage: RenderBench [--asteroids 200] [--bullets 100] [--enemies 4] [--dust 255] [--particles 0]
+//                    [--views 1] [--frames 600] [--width 400] [--height 300] [--software]
+//                    [--png path]
+
+#include "../libs/raylib/src/raylib.h"
+#include "../libs/raylib/src/raymath.h"
+
+#include "../src/World.hpp"
+#include "../src/GameCamera.hpp"
+#include "../src/SpaceDust.hpp"
+#include "../src/Skybox.hpp"
+#include "../src/RenderQueue.hpp"
+#include "../src/WorldRenderer.hpp"
+#include "../src/FrameArena.hpp"
+#include "../src/ParticleSystem.hpp"
+#include "../src/Random.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(PLATFORM_DESKTOP)
+    #define GLSL_VERSION 330
+#else
+    #define GLSL_VERSION 100
+#endif
+
+// Frames drawn before timing starts, so asteroids have grown in and enemies have left trails.
+static const int WarmupFrames = 120;
+static const float FrameStep = 1.0f / 60;
+
+static Vector3 randomDirection(Random& random) {
+    Vector3 direction = { random.rangeFloat(-1, 1), random.rangeFloat(-1, 1), random.rangeFloat(-1, 1) };
+    return Vector3Length(direction) > 0.01f ? Vector3Normalize(direction) : Vector3{ 0, 0, 1 };
+}
+
+// Puts back whatever the last update destroyed, so every frame draws the same amount.
+static void fillScene(World& world, Model asteroidModel, Random& random, int asteroids, int bullets, int enemies) {
+    Vector3 center = world.player.position;
+
+    // A shell around the player, clear of it so it never crashes.
+    while ((int)world.asteroids.size() < asteroids) {
+        Vector3 position = Vector3Add(center, Vector3Scale(randomDirection(random), random.rangeFloat(8, 45)));
+        Vector3 rotation = { random.rangeFloat(1, 7), random.rangeFloat(1, 7), random.rangeFloat(1, 7) };
+        Asteroid asteroid(asteroidModel, position, Vector3Zero(), rotation,
+                          random.range(0, AsteroidShapeSeeds - 1));
+        asteroid.scale = 1;
+        world.asteroids.push_back(asteroid);
+    }
+
+    while ((int)world.bullets.size() < bullets) {
+        Vector3 position = Vector3Add(center, Vector3Scale(randomDirection(random), random.rangeFloat(2, 20)));
+        Bullet bullet(false, RED, position, Vector3Scale(randomDirection(random), 100));
+        bullet.timeElapsed = random.rangeFloat(0, 1);
+        world.bullets.push_back(bullet);
+    }
+
+    while ((int)world.enemies.size() < enemies)
+        world.summonEnemy();
+}
+
+static float average(const std::vector<float>& values) {
+    float total = 0;
+    for (float value : values)
+        total += value;
+    return values.empty() ? 0 : total / values.size();
+}
+
+static float percentile(std::vector<float> values, float fraction) {
+    if (values.empty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    return values[std::min((size_t)(fraction * values.size()), values.size() - 1)];
+}
+
+int main(int argc, char** argv) {
+    int asteroidCount = 200;
+    int bulletCount = 100;
+    int enemyCount = 4;
+    int dustCount = 255;
+    int particleCount = 0;
+    int viewCount = 1;
+    int frameCount = 600;
+    int renderWidth = 400;
+    int renderHeight = 300;
+    bool software = false;
+    const char* pngPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--asteroids") == 0 && i + 1 < argc) {
+            asteroidCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bullets") == 0 && i + 1 < argc) {
+            bulletCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--enemies") == 0 && i + 1 < argc) {
+            enemyCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dust") == 0 && i + 1 < argc) {
+            dustCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--particles") == 0 && i + 1 < argc) {
+            particleCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--views") == 0 && i + 1 < argc) {
+            viewCount = std::min(std::max(atoi(argv[++i]), 1), MaxViews);
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frameCount = std::max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--width") == 0 && i + 1 < argc) {
+            renderWidth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--height") == 0 && i + 1 < argc) {
+            renderHeight = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--software") == 0) {
+            software = true;
+        } else if (strcmp(argv[i], "--png") == 0 && i + 1 < argc) {
+            pngPath = argv[++i];
+        } else {
+            printf("Usage: %s [--asteroids 200] [--bullets 100] [--enemies 4] [--dust 255] [--particles 0]\n"
+                   "       [--views 1] [--frames 600] [--width 400] [--height 300] [--software]\n"
+                   "       [--png path]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Has to be set before the GL context is made. Only Mesa reads these.
+    if (software) {
+#if defined(_WIN32)
+        _putenv_s("LIBGL_ALWAYS_SOFTWARE", "1");
+        _putenv_s("GALLIUM_DRIVER", "llvmpipe");
+#else
+        setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+        setenv("GALLIUM_DRIVER", "llvmpipe", 1);
+#endif
+    }
+
+    // Raylib logs the GL renderer while the window opens, which says whether llvmpipe was used.
+    SetConfigFlags(ConfigFlags::FLAG_WINDOW_HIDDEN);
+    InitWindow(renderWidth, renderHeight, "RenderBench");
+    SetTraceLogLevel(LOG_WARNING);
+
+    RenderTexture2D renderTarget = LoadRenderTexture(renderWidth, renderHeight);
+    SetTextureFilter(renderTarget.texture, TextureFilter::TEXTURE_FILTER_POINT);
+
+    Skybox skybox("assets/background.png", GLSL_VERSION);
+    Crosshair crosshairFar("assets/crosshairNew.gltf");
+    Crosshair crosshairNear("assets/crosshairNew.gltf");
+    Model shipModel = LoadModel("assets/ship.gltf");
+    Model asteroidModel = LoadModel("assets/asteroid.gltf");
+    Shader asteroidShader = LoadShader(TextFormat("assets/shaders/glsl%i/asteroid.vs", GLSL_VERSION),
+                                       TextFormat("assets/shaders/glsl%i/asteroid.fs", GLSL_VERSION));
+    Asteroid::setShapeShader(asteroidModel, asteroidShader);
+
+    // Everything from here on is seeded, so every run draws the same frames. Dust is the
+    // exception, it uses raylib's random numbers.
+    SetRandomSeed(1);
+    World world(shipModel, asteroidModel, 1);
+    Random random(2);
+    SpaceDust dust(25, dustCount);
+
+    // The first view follows the player, the others enemies.
+    std::vector<GameCamera> cameras(viewCount, GameCamera(true, 50));
+    if (viewCount > 1) {
+        for (int i = 0; i < viewCount; ++i)
+            cameras[i].setViewport(getSplitViewport(i, viewCount, renderWidth, renderHeight), renderWidth, renderHeight);
+    }
+
+    ParticleSystem particles(std::max(particleCount, 1));
+    particles.loadRenderer(GLSL_VERSION);
+
+    FrameArena frameArena(256 * 1024);
+    // The field adds its own asteroids on top of the scripted ones.
+    RenderQueue renderQueue(asteroidCount + bulletCount + enemyCount * 3 + 1024);
+
+    WorldView views[MaxViews];
+    for (int i = 0; i < viewCount; ++i) {
+        Rectangle viewport = getSplitViewport(i, viewCount, renderWidth, renderHeight);
+        views[i].camera = &cameras[i];
+        views[i].skybox = &skybox;
+        views[i].dust = &dust;
+        views[i].particles = &particles;
+        views[i].width = (int)viewport.width;
+        views[i].height = (int)viewport.height;
+    }
+    views[0].crosshairFar = &crosshairFar;
+    views[0].crosshairNear = &crosshairNear;
+
+    typedef std::chrono::steady_clock Clock;
+    std::vector<float> submitTimes;
+    std::vector<float> sharedTimes;
+    std::vector<float> viewTimes[MaxViews];
+    std::vector<float> frameTimes;
+    submitTimes.reserve(frameCount);
+    sharedTimes.reserve(frameCount);
+    for (int i = 0; i < viewCount; ++i)
+        viewTimes[i].reserve(frameCount);
+    frameTimes.reserve(frameCount);
+    double drawCalls = 0;
+    double stateChanges = 0;
+    double batchFlushes = 0;
+    Clock::time_point benchStart = Clock::now();
+
+    for (int frame = 0; frame < WarmupFrames + frameCount; ++frame) {
+        if (frame == WarmupFrames)
+            benchStart = Clock::now();
+        Clock::time_point frameStart = Clock::now();
+
+        // The player turns slowly in place so the view sweeps the scene. Enemies circle it.
+        world.player.inputYawLeft = 0.3f;
+        for (auto &enemy : world.enemies) {
+            enemy.inputForward = 1;
+            enemy.inputYawLeft = 0.6f;
+        }
+
+        world.update(FrameStep);
+        world.player.isDead = false;
+        fillScene(world, asteroidModel, random, asteroidCount, bulletCount, enemyCount);
+
+        // Explosions around the scene keep about the asked for number of particles alive.
+        while (particles.getCount() + 500 <= particleCount) {
+            Vector3 position = Vector3Add(world.player.position,
+                                          Vector3Scale(randomDirection(random), random.rangeFloat(5, 30)));
+            particles.emitBurst(position, Vector3Zero(), 500, 6, 1.5f, ORANGE);
+        }
+        particles.update(FrameStep);
+        particles.upload();
+
+        for (int i = 0; i < viewCount; ++i) {
+            const Ship& ship = i > 0 && i <= (int)world.enemies.size() ? world.enemies[i - 1] : world.player;
+            cameras[i].followShip(ship, FrameStep);
+            views[i].ship = &ship;
+        }
+
+        // Submit time covers building the queue and the GL calls that execute it, up to the
+        // last batch being flushed. The GPU may still be working after that.
+        Clock::time_point submitStart = Clock::now();
+        SharedWorld shared = prepareWorld(frameArena, world, views, viewCount);
+        Clock::time_point sharedEnd = Clock::now();
+
+        BeginTextureMode(renderTarget);
+        ClearBackground(BLACK);
+        float viewTime[MaxViews];
+        RenderQueue::Stats stats;
+        for (int i = 0; i < viewCount; ++i) {
+            Clock::time_point viewStart = Clock::now();
+            renderQueue.begin(cameras[i].getPosition(), frameArena);
+            submitWorld(renderQueue, frameArena, world, shared, views[i]);
+            renderQueue.execute(cameras[i]);
+            viewTime[i] = std::chrono::duration<float>(Clock::now() - viewStart).count();
+
+            stats.drawCalls += renderQueue.getStats().drawCalls;
+            stats.stateChanges += renderQueue.getStats().stateChanges;
+            stats.batchFlushes += renderQueue.getStats().batchFlushes;
+        }
+        EndTextureMode();
+        float submitTime = std::chrono::duration<float>(Clock::now() - submitStart).count();
+
+        BeginDrawing();
+        ClearBackground(BLACK);
+        DrawTexturePro(renderTarget.texture, { 0, 0, (float)renderWidth, (float)-renderHeight },
+                       { 0, 0, (float)renderWidth, (float)renderHeight }, { 0, 0 }, 0, WHITE);
+        EndDrawing();
+
+        frameArena.reset();
+
+        if (frame >= WarmupFrames) {
+            submitTimes.push_back(submitTime * 1000);
+            sharedTimes.push_back(std::chrono::duration<float>(sharedEnd - submitStart).count() * 1000);
+            for (int i = 0; i < viewCount; ++i)
+                viewTimes[i].push_back(viewTime[i] * 1000);
+            frameTimes.push_back(std::chrono::duration<float>(Clock::now() - frameStart).count() * 1000);
+            drawCalls += stats.drawCalls;
+            stateChanges += stats.stateChanges;
+            batchFlushes += stats.batchFlushes;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(Clock::now() - benchStart).count();
+
+    int fieldAsteroids = 0;
+    world.field.forEachAsteroid([&](const Asteroid&) { fieldAsteroids++; });
+
+    printf("scene: %d asteroids (+%d in the field), %d bullets, %d enemies, %d dust, %d particles, %dx%d, %d views\n",
+           (int)world.asteroids.size(), fieldAsteroids, (int)world.bullets.size(),
+           (int)world.enemies.size(), dustCount, particles.getCount(), renderWidth, renderHeight, viewCount);
+    printf("submit ms: avg %.3f  p50 %.3f  p95 %.3f  max %.3f\n",
+           average(submitTimes), percentile(submitTimes, 0.5f), percentile(submitTimes, 0.95f),
+           percentile(submitTimes, 1));
+    printf("shared ms: avg %.3f  p95 %.3f\n", average(sharedTimes), percentile(sharedTimes, 0.95f));
+    for (int i = 0; i < viewCount; ++i) {
+        printf("view %d ms: avg %.3f  p95 %.3f\n", i, average(viewTimes[i]), percentile(viewTimes[i], 0.95f));
+    }
+    printf("frame ms: p50 %.3f  p95 %.3f\n", percentile(frameTimes, 0.5f), percentile(frameTimes, 0.95f));
+    printf("per frame: %.1f draw calls  %.1f state changes  %.1f batch flushes\n",
+           drawCalls / frameCount, stateChanges / frameCount, batchFlushes / frameCount);
+    printf("fps: %.1f over %d frames\n", frameCount / seconds, frameCount);
+
+    if (pngPath) {
+        Image image = LoadImageFromTexture(renderTarget.texture);
+        ImageFlipVertical(&image);
+        if (!ExportImage(image, pngPath))
+            printf("Couldn't write %s\n", pngPath);
+        UnloadImage(image);
+    }
+
+    UnloadRenderTexture(renderTarget);
+    UnloadModel(shipModel);
+    UnloadModel(asteroidModel);
+    UnloadShader(asteroidShader);
+    CloseWindow();
+    return 0;
+}
@@ -0,0 +1,131 @@
+// Connects a number of headless clients to a server and flies them around randomly. Used to load
+// test the server and to measure how many bytes snapshots actually take.
+//
+// Usage: HypersonicBot [--host 127.0.0.1] [--port 27015] [--bots 8] [--duration 30]
+
+#include "../libs/raylib/src/raylib.h"
+
+#include "../src/NetClient.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+struct Bot {
+    std::unique_ptr<NetClient> client;
+    NetInput input;
+    float steerTimer;
+};
+
+static int8_t randomAxis() {
+    return (int8_t)GetRandomValue(-127, 127);
+}
+
+int main(int argc, char** argv) {
+    const char* host = "127.0.0.1";
+    int port = NetDefaultPort;
+    int botCount = 8;
+    float runSeconds = 30;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--host") == 0 && i + 1 < argc) {
+            host = argv[++i];
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bots") == 0 && i + 1 < argc) {
+            botCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            runSeconds = (float)atof(argv[++i]);
+        } else {
+            printf("Usage: %s [--host 127.0.0.1] [--port %u] [--bots 8] [--duration 30]\n", argv[0], NetDefaultPort);
+            return 1;
+        }
+    }
+
+    NetAddress server;
+    if (!resolveAddress(host, (uint16_t)port, server)) {
+        printf("Couldn't resolve %s\n", host);
+        return 1;
+    }
+
+    std::vector<Bot> bots(botCount);
+    for (auto& bot : bots) {
+        bot.client.reset(new NetClient());
+        bot.steerTimer = 0;
+        if (!bot.client->connect(server)) {
+            printf("Couldn't open a UDP socket\n");
+            return 1;
+        }
+    }
+
+    // Bots send input at the same rate the game would.
+    const float frameTime = 1.0f / 60;
+
+    using namespace std::chrono;
+    auto start = steady_clock::now();
+    auto nextFrame = start;
+    auto lastReport = start;
+
+    while (duration<float>(steady_clock::now() - start).count() < runSeconds) {
+        for (auto& bot : bots) {
+            bot.client->update();
+            if (!bot.client->isConnected())
+                continue;
+
+            bot.steerTimer -= frameTime;
+            if (bot.steerTimer <= 0) {
+                bot.steerTimer = GetRandomValue(5, 20) / 10.0f;
+                bot.input.yawLeft = randomAxis();
+                bot.input.pitchDown = randomAxis();
+                bot.input.rollRight = randomAxis();
+                bot.input.buttons = GetRandomValue(0, 2) == 0 ? NetButtonFire : 0;
+            }
+
+            bot.client->sendInput(bot.input);
+        }
+
+        auto now = steady_clock::now();
+        if (now - lastReport >= seconds(1)) {
+            lastReport = now;
+
+            int connected = 0;
+            size_t entities = 0;
+            for (auto& bot : bots) {
+                if (bot.client->isConnected()) {
+                    connected++;
+                    entities = bot.client->getSnapshot().entities.size();
+                }
+            }
+            printf("%d/%d bots connected  %zu entities\n", connected, botCount, entities);
+            fflush(stdout);
+        }
+
+        nextFrame += duration_cast<steady_clock::duration>(duration<float>(frameTime));
+        std::this_thread::sleep_until(nextFrame);
+    }
+
+    NetClient::Stats total;
+    for (auto& bot : bots) {
+        const NetClient::Stats& stats = bot.client->getStats();
+        total.snapshotsReceived += stats.snapshotsReceived;
+        total.bytesReceived += stats.bytesReceived;
+        total.decodeFailures += stats.decodeFailures;
+        bot.client->disconnect();
+    }
+
+    double averageSnapshot = total.snapshotsReceived
+        ? total.bytesReceived / (double)total.snapshotsReceived
+        : 0;
+
+    printf("snapshots %llu  bytes %llu  average %.1f bytes/snapshot  decode failures %llu\n",
+           (unsigned long long)total.snapshotsReceived,
+           (unsigned long long)total.bytesReceived,
+           averageSnapshot,
+           (unsigned long long)total.decodeFailures);
+
+    return total.decodeFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,542 @@
+// Dedicated, windowless Hypersonic server. It owns all ships, bullets and asteroids, applies the
+// input clients send, and sends each client a snapshot of the world every tick, delta compressed
+// against the newest snapshot that client has acknowledged.
+//
+// Usage: HypersonicServer [--port 27015] [--tick-rate 30] [--duration seconds]
+//                         [--metrics path] [--metrics-format prometheus|json] [--metrics-interval 10]
+
+#include "../libs/raylib/src/raylib.h"
+#include "../libs/raylib/src/raymath.h"
+
+#include "../src/Ship.hpp"
+#include "../src/Bullet.hpp"
+#include "../src/Asteroid.hpp"
+#include "../src/NetProtocol.hpp"
+#include "../src/NetSocket.hpp"
+#include "../src/Metrics.hpp"
+#include "../src/Random.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+static const float ClientTimeout = 5.0f;
+static const float FireCooldown = 0.2f;
+static const float AsteroidInterval = 2.0f;
+static const float AsteroidCullDistance = 50.0f;
+
+struct ServerClient {
+    NetAddress address;
+    uint16_t shipId;
+    NetInput input;
+    float silentTime;
+    float fireCooldown;
+
+    // Bytes sent this reporting interval.
+    uint64_t bytesSent;
+    int largestPacket;
+};
+
+struct ServerShip {
+    uint16_t id;
+    Ship ship;
+};
+
+struct ServerBullet {
+    uint16_t id;
+    uint16_t ownerId;
+    uint32_t spawnTick;
+    Vector3 origin;
+    Bullet bullet;
+};
+
+struct ServerAsteroid {
+    uint16_t id;
+    uint32_t spawnTick;
+    Vector3 origin;
+    Asteroid asteroid;
+};
+
+class Server {
+    public:
+        Server(int tickRate);
+
+        bool open(uint16_t port);
+        void tick();
+
+        // Prints and resets the bandwidth counters.
+        void report(float seconds);
+
+        Metrics metrics;
+
+    private:
+        UdpSocket socket;
+        int tickRate;
+        float tickInterval;
+        uint32_t currentTick = 0;
+        NetIdAllocator entityIds;
+        float asteroidTimer = 0;
+        Random random;
+
+        std::vector<ServerClient> clients;
+        std::vector<ServerShip> ships;
+        std::vector<ServerBullet> bullets;
+        std::vector<ServerAsteroid> asteroids;
+
+        NetSnapshotHistory history;
+        NetSnapshot empty;
+        uint8_t packet[NetMaxPacketSize];
+
+        uint32_t reportTicks = 0;
+
+        int tickTimeMetric;
+        int ticksMetric;
+        int clientsMetric;
+        int shipsMetric;
+        int bulletsMetric;
+        int asteroidsMetric;
+        int sentBytesMetric;
+        int memoryMetric;
+
+        void receivePackets();
+        void addClient(const NetAddress& address);
+        void removeClient(size_t index);
+        void sendAccept(const ServerClient& client);
+
+        void simulate();
+        void respawn(Ship& ship);
+        void buildSnapshot(NetSnapshot& snapshot) const;
+        void sendSnapshots(const NetSnapshot& snapshot);
+
+        Ship* findShip(uint16_t id);
+};
+
+Server::Server(int tickRate) : metrics(HYPERSONIC_BUILD), random((uint64_t)time(nullptr)) {
+    this->tickRate = tickRate;
+    this->tickInterval = 1.0f / tickRate;
+
+    ticksMetric = metrics.addCounter("server_ticks_total", "Server ticks run.");
+    tickTimeMetric = metrics.addHistogram("server_tick_seconds", "Time a server tick takes, sending included.",
+                                          { 0.00025, 0.0005, 0.001, 0.002, 0.004, 0.008, 0.016, 0.033 });
+    clientsMetric = metrics.addGauge("server_clients", "Connected clients.");
+    shipsMetric = metrics.addGauge("server_ships", "Live ships.");
+    bulletsMetric = metrics.addGauge("server_bullets", "Live bullets.");
+    asteroidsMetric = metrics.addGauge("server_asteroids", "Live asteroids.");
+    sentBytesMetric = metrics.addCounter("server_sent_bytes_total", "Snapshot bytes sent to clients.");
+    memoryMetric = metrics.addGauge("resident_memory_bytes", "Physical memory in use.");
+}
+
+bool Server::open(uint16_t port) {
+    return socket.open(port);
+}
+
+Ship* Server::findShip(uint16_t id) {
+    for (auto& ship : ships) {
+        if (ship.id == id)
+            return &ship.ship;
+    }
+    return nullptr;
+}
+
+void Server::tick() {
+    auto start = std::chrono::steady_clock::now();
+    currentTick++;
+    reportTicks++;
+
+    receivePackets();
+    simulate();
+
+    NetSnapshot& snapshot = history.insert(currentTick);
+    buildSnapshot(snapshot);
+    sendSnapshots(snapshot);
+
+    metrics.increment(ticksMetric);
+    metrics.observe(tickTimeMetric, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    metrics.set(clientsMetric, (double)clients.size());
+    metrics.set(shipsMetric, (double)ships.size());
+    metrics.set(bulletsMetric, (double)bullets.size());
+    metrics.set(asteroidsMetric, (double)asteroids.size());
+    metrics.update(tickInterval);
+}
+
+void Server::receivePackets() {
+    for (auto& client : clients)
+        client.silentTime += tickInterval;
+
+    NetAddress from;
+    int size;
+    while ((size = socket.receive(from, packet, sizeof(packet))) > 0) {
+        BitReader reader(packet, size);
+        NetPacketType type;
+        if (!readPacketHeader(reader, type))
+            continue;
+
+        auto client = std::find_if(clients.begin(), clients.end(), [&](const ServerClient& c) {
+            return c.address == from;
+        });
+
+        if (type == NetPacketType::CONNECT) {
+            // A repeated connect means our accept got lost.
+            if (client == clients.end()) {
+                addClient(from);
+            } else {
+                sendAccept(*client);
+            }
+            continue;
+        }
+
+        if (client == clients.end())
+            continue;
+
+        client->silentTime = 0;
+
+        if (type == NetPacketType::INPUT) {
+            NetInput input;
+            readInput(reader, input);
+
+            // Inputs can arrive out of order. Only the newest one matters.
+            if (!reader.hasOverflowed() && input.sequence > client->input.sequence)
+                client->input = input;
+        } else if (type == NetPacketType::DISCONNECT) {
+            removeClient(client - clients.begin());
+        }
+    }
+
+    for (size_t i = clients.size(); i-- > 0;) {
+        if (clients[i].silentTime > ClientTimeout)
+            removeClient(i);
+    }
+}
+
+void Server::addClient(const NetAddress& address) {
+    uint16_t id = entityIds.allocate();
+    if (id == 0) {
+        printf("Out of entity ids, turning a client away\n");
+        return;
+    }
+
+    ServerShip ship = { id, Ship(Model(), false) };
+    respawn(ship.ship);
+    ships.push_back(ship);
+
+    ServerClient client = {};
+    client.address = address;
+    client.shipId = ship.id;
+    clients.push_back(client);
+
+    sendAccept(client);
+    printf("Client %u.%u.%u.%u:%u joined as ship %u\n",
+           (address.host >> 24) & 255, (address.host >> 16) & 255,
+           (address.host >> 8) & 255, address.host & 255,
+           address.port, ship.id);
+}
+
+void Server::removeClient(size_t index) {
+    uint16_t shipId = clients[index].shipId;
+    entityIds.release(shipId);
+    ships.erase(std::remove_if(ships.begin(), ships.end(), [&](const ServerShip& ship) {
+        return ship.id == shipId;
+    }), ships.end());
+
+    clients.erase(clients.begin() + index);
+    printf("Ship %u left\n", shipId);
+}
+
+void Server::sendAccept(const ServerClient& client) {
+    BitWriter writer(packet, sizeof(packet));
+    writePacketHeader(writer, NetPacketType::ACCEPT);
+    writer.write(client.shipId, 16);
+    writer.write((uint32_t)tickRate, 8);
+    socket.send(client.address, packet, writer.finish());
+}
+
+void Server::respawn(Ship& ship) {
+    ship.position = { random.rangeFloat(-50, 50), random.rangeFloat(-50, 50), random.rangeFloat(-50, 50) };
+    ship.velocity = Vector3Zero();
+    ship.rotation = QuaternionFromEuler(random.rangeFloat(-PI, PI), random.rangeFloat(-PI, PI), 0);
+}
+
+void Server::simulate() {
+    // Apply input and fire
+    for (auto& client : clients) {
+        Ship* ship = findShip(client.shipId);
+        if (!ship)
+            continue;
+
+        ship->inputForward = 1;
+        ship->inputYawLeft = client.input.yawLeft / 127.0f;
+        ship->inputPitchDown = client.input.pitchDown / 127.0f;
+        ship->inputRollRight = client.input.rollRight / 127.0f;
+
+        client.fireCooldown -= tickInterval;
+        if ((client.input.buttons & NetButtonFire) && client.fireCooldown <= 0) {
+            client.fireCooldown = FireCooldown;
+
+            uint16_t id = entityIds.allocate();
+            if (id == 0)
+                continue;
+
+            ServerBullet bullet = {
+                id,
+                client.shipId,
+                currentTick,
+                ship->position,
+                Bullet(false, RED, ship->position, Vector3Scale(ship->getForward(), 100))
+            };
+            bullets.push_back(bullet);
+        }
+    }
+
+    for (auto& ship : ships)
+        ship.ship.update(tickInterval);
+
+    // Every ship gets asteroids thrown at it, like in the single player game.
+    asteroidTimer += tickInterval;
+    if (asteroidTimer >= AsteroidInterval) {
+        asteroidTimer -= AsteroidInterval;
+
+        for (auto& ship : ships) {
+            Vector3 position = Vector3Add(ship.ship.position, Vector3Scale(ship.ship.getForward(), 40));
+            Vector3 velocity = Vector3Scale(ship.ship.getForward(), 20);
+            Vector3 rotation = { random.rangeFloat(1, 7), random.rangeFloat(1, 7), random.rangeFloat(1, 7) };
+            uint16_t id = entityIds.allocate();
+            if (id == 0)
+                break;
+
+            // Clients can work out the shape from the id, so it doesn't have to be sent.
+            ServerAsteroid asteroid = {
+                id,
+                currentTick,
+                position,
+                Asteroid(Model(), position, velocity, rotation, id % AsteroidShapeSeeds)
+            };
+            asteroids.push_back(asteroid);
+        }
+    }
+
+    for (auto& bullet : bullets) {
+        Vector3 from = bullet.bullet.position;
+        bullet.bullet.update(tickInterval);
+
+        for (auto& ship : ships) {
+            if (ship.id != bullet.ownerId
+                && Vector3Distance(ship.ship.position, bullet.bullet.position) < 0.5) {
+                bullet.bullet.isDead = true;
+                respawn(ship.ship);
+            }
+        }
+
+        for (auto& asteroid : asteroids) {
+            // No models are loaded here, so this sweeps against the collision sphere.
+            if (asteroid.asteroid.isHitBySegment(nullptr, from, bullet.bullet.position)) {
+                bullet.bullet.isDead = true;
+                asteroid.asteroid.isDead = true;
+            }
+        }
+    }
+
+    for (auto& asteroid : asteroids) {
+        asteroid.asteroid.update(tickInterval);
+
+        bool nearShip = false;
+        for (auto& ship : ships) {
+            if (Vector3Distance(asteroid.asteroid.position, ship.ship.position) <= AsteroidCullDistance)
+                nearShip = true;
+        }
+
+        if (!nearShip)
+            asteroid.asteroid.isDead = true;
+    }
+
+    // Ids go back to the allocator once their entity is gone.
+    bullets.erase(std::remove_if(bullets.begin(), bullets.end(), [&](const ServerBullet& bullet) {
+        if (bullet.bullet.isDead)
+            entityIds.release(bullet.id);
+        return bullet.bullet.isDead;
+    }), bullets.end());
+
+    asteroids.erase(std::remove_if(asteroids.begin(), asteroids.end(), [&](const ServerAsteroid& asteroid) {
+        if (asteroid.asteroid.isDead)
+            entityIds.release(asteroid.id);
+        return asteroid.asteroid.isDead;
+    }), asteroids.end());
+}
+
+void Server::buildSnapshot(NetSnapshot& snapshot) const {
+    for (auto& ship : ships) {
+        NetEntity entity;
+        entity.id = ship.id;
+        entity.type = NetEntityType::SHIP;
+        entity.position[0] = quantizePosition(ship.ship.position.x);
+        entity.position[1] = quantizePosition(ship.ship.position.y);
+        entity.position[2] = quantizePosition(ship.ship.position.z);
+        entity.rotation = packQuaternion(ship.ship.rotation);
+        snapshot.entities.push_back(entity);
+    }
+
+    // Bullets and asteroids are sent as where they spawned, so they never change afterwards.
+    for (auto& bullet : bullets) {
+        NetEntity entity;
+        entity.id = bullet.id;
+        entity.type = NetEntityType::BULLET;
+        entity.flags = bullet.bullet.isEnemy ? 1 : 0;
+        entity.position[0] = quantizePosition(bullet.origin.x);
+        entity.position[1] = quantizePosition(bullet.origin.y);
+        entity.position[2] = quantizePosition(bullet.origin.z);
+        entity.velocity[0] = quantizeVelocity(bullet.bullet.velocity.x);
+        entity.velocity[1] = quantizeVelocity(bullet.bullet.velocity.y);
+        entity.velocity[2] = quantizeVelocity(bullet.bullet.velocity.z);
+        entity.spawnTick = bullet.spawnTick;
+        snapshot.entities.push_back(entity);
+    }
+
+    for (auto& asteroid : asteroids) {
+        NetEntity entity;
+        entity.id = asteroid.id;
+        entity.type = NetEntityType::ASTEROID;
+        entity.position[0] = quantizePosition(asteroid.origin.x);
+        entity.position[1] = quantizePosition(asteroid.origin.y);
+        entity.position[2] = quantizePosition(asteroid.origin.z);
+        entity.rotation = packQuaternion(QuaternionFromMatrix(asteroid.asteroid.model.transform));
+        entity.velocity[0] = quantizeVelocity(asteroid.asteroid.velocity.x);
+        entity.velocity[1] = quantizeVelocity(asteroid.asteroid.velocity.y);
+        entity.velocity[2] = quantizeVelocity(asteroid.asteroid.velocity.z);
+        entity.spawnTick = asteroid.spawnTick;
+        snapshot.entities.push_back(entity);
+    }
+
+    std::sort(snapshot.entities.begin(), snapshot.entities.end(), [](const NetEntity& a, const NetEntity& b) {
+        return a.id < b.id;
+    });
+}
+
+void Server::sendSnapshots(const NetSnapshot& snapshot) {
+    for (auto& client : clients) {
+        // Delta against the newest snapshot the client has acknowledged, if we still have it.
+        const NetSnapshot* baseline = history.find(client.input.ackTick);
+        if (baseline == &snapshot)
+            baseline = nullptr;
+
+        BitWriter writer(packet, sizeof(packet));
+        writePacketHeader(writer, NetPacketType::SNAPSHOT);
+        writer.write(currentTick, 32);
+        writer.write(baseline ? baseline->tick : 0, 32);
+        writer.write(client.shipId, 16);
+        writeSnapshotDelta(writer, baseline ? *baseline : empty, snapshot);
+
+        int size = writer.finish();
+        if (writer.hasOverflowed()) {
+            printf("Snapshot for ship %u doesn't fit in a packet, skipping it\n", client.shipId);
+            continue;
+        }
+
+        socket.send(client.address, packet, size);
+        client.bytesSent += size;
+        metrics.increment(sentBytesMetric, size);
+        client.largestPacket = std::max(client.largestPacket, size);
+    }
+}
+
+void Server::report(float seconds) {
+    if (reportTicks == 0)
+        return;
+
+    metrics.set(memoryMetric, (double)getResidentMemory());
+
+    size_t entities = ships.size() + bullets.size() + asteroids.size();
+    printf("tick %u  %.0f ticks/s  clients %zu  entities %zu\n",
+           currentTick, reportTicks / seconds, clients.size(), entities);
+
+    for (auto& client : clients) {
+        printf("  ship %5u  %7.1f bytes/tick  largest %5d bytes\n",
+               client.shipId, client.bytesSent / (double)reportTicks, client.largestPacket);
+        client.bytesSent = 0;
+        client.largestPacket = 0;
+    }
+
+    fflush(stdout);
+    reportTicks = 0;
+}
+
+int main(int argc, char** argv) {
+    int port = NetDefaultPort;
+    int tickRate = 30;
+    float runSeconds = 0;
+    const char* metricsPath = nullptr;
+    MetricsFormat metricsFormat = MetricsFormat::PROMETHEUS;
+    float metricsInterval = 10;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            tickRate = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            runSeconds = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            metricsPath = argv[++i];
+        } else if (strcmp(argv[i], "--metrics-format") == 0 && i + 1 < argc
+                   && parseMetricsFormat(argv[i + 1], metricsFormat)) {
+            ++i;
+        } else if (strcmp(argv[i], "--metrics-interval") == 0 && i + 1 < argc
+                   && parseMetricsInterval(argv[i + 1], metricsInterval)) {
+            ++i;
+        } else {
+            printf("Usage: %s [--port %u] [--tick-rate 30] [--duration seconds]\n"
+                   "       [--metrics path] [--metrics-format prometheus|json] [--metrics-interval 10]\n",
+                   argv[0], NetDefaultPort);
+            return 1;
+        }
+    }
+
+    if (tickRate < 1 || tickRate > 255) {
+        printf("Tick rate must be between 1 and 255\n");
+        return 1;
+    }
+
+    Server server(tickRate);
+    if (!server.open((uint16_t)port)) {
+        printf("Couldn't open UDP port %d\n", port);
+        return 1;
+    }
+
+    if (metricsPath && !server.metrics.openFile(metricsPath, metricsFormat, metricsInterval)) {
+        printf("Couldn't open %s for metrics\n", metricsPath);
+        return 1;
+    }
+
+    printf("Hypersonic server listening on UDP port %d at %d ticks/s\n", port, tickRate);
+    fflush(stdout);
+
+    using namespace std::chrono;
+    auto tickDuration = duration_cast<steady_clock::duration>(duration<double>(1.0 / tickRate));
+    auto start = steady_clock::now();
+    auto nextTick = start;
+    auto lastReport = start;
+
+    while (runSeconds <= 0 || duration<float>(steady_clock::now() - start).count() < runSeconds) {
+        server.tick();
+
+        auto now = steady_clock::now();
+        float sinceReport = duration<float>(now - lastReport).count();
+        if (sinceReport >= 1.0f) {
+            server.report(sinceReport);
+            lastReport = now;
+        }
+
+        // Deadlines advance by exactly one tick so the tick rate doesn't drift. If the server fell
+        // far behind, skip ahead instead of trying to catch up with a burst of ticks.
+        nextTick += tickDuration;
+        if (now - nextTick > tickDuration * 4)
+            nextTick = now;
+        std::this_thread::sleep_until(nextTick);
+    }
+
+    server.metrics.write();
+    return 0;
+}
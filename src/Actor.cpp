@@ -2,6 +2,8 @@
 
 #include "../libs/raylib/src/raymath.h"
 
+#include "SimdMath.hpp"
+
 Actor::Actor() {
     position = Vector3Zero();
     velocity = Vector3Zero();
@@ -9,52 +11,37 @@ Actor::Actor() {
 }
 
 Vector3 Actor::getForward() const {
-    return Vector3RotateByQuaternion(
-            Vector3{ 0, 0, 1 },
-            rotation);
+    return rotateVector(rotation, Vector3{ 0, 0, 1 });
 }
 
 Vector3 Actor::getBack() const {
-    return Vector3RotateByQuaternion(
-            Vector3{ 0, 0, -1 },
-            rotation);
+    return rotateVector(rotation, Vector3{ 0, 0, -1 });
 }
 
 Vector3 Actor::getRight() const {
-    return Vector3RotateByQuaternion(
-            Vector3{ -1, 0, 0 },
-            rotation);
+    return rotateVector(rotation, Vector3{ -1, 0, 0 });
 }
 
 Vector3 Actor::getLeft() const {
-    return Vector3RotateByQuaternion(
-            Vector3{ 1, 0, 0 },
-            rotation);
+    return rotateVector(rotation, Vector3{ 1, 0, 0 });
 }
 
 Vector3 Actor::getUp() const {
-    return Vector3RotateByQuaternion(
-            Vector3{ 0, 1, 0 },
-            rotation);
+    return rotateVector(rotation, Vector3{ 0, 1, 0 });
 }
 
 Vector3 Actor::getDown() const
 {
-    return Vector3RotateByQuaternion(
-            Vector3{ 0, -1, 0 },
-            rotation);
+    return rotateVector(rotation, Vector3{ 0, -1, 0 });
 }
 
 Vector3 Actor::transformPoint(Vector3 point) const {
-    auto mPos = MatrixTranslate(position.x, position.y, position.z);
-    auto mRot = QuaternionToMatrix(rotation);
-    auto matrix = MatrixMultiply(mRot, mPos);
-    return Vector3Transform(point, matrix);
+    return Vector3Add(position, rotateVector(rotation, point));
 }
 
 void Actor::rotateLocalEuler(Vector3 axis, float degrees) {
     auto radians = degrees * DEG2RAD;
-    rotation = QuaternionMultiply(
+    rotation = multiplyQuaternions(
             rotation,
             QuaternionFromAxisAngle(axis, radians));
 }
@@ -0,0 +1,79 @@
+#include "AllocationTracker.hpp"
+
+#if defined(HYPERSONIC_TRACK_ALLOCATIONS)
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replacing the global operators only works because this file is linked straight into the
+// executable. From inside a static library the linker could leave it out.
+static std::atomic<uint64_t> allocationCount(0);
+static std::atomic<uint64_t> allocationBytes(0);
+
+static void* trackedAllocate(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+void* operator new(size_t size) {
+    void* pointer = trackedAllocate(size);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](size_t size) {
+    void* pointer = trackedAllocate(size);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return trackedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return trackedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    free(pointer);
+}
+
+bool isAllocationTrackingEnabled() {
+    return true;
+}
+
+AllocationStats getAllocationStats() {
+    AllocationStats stats;
+    stats.count = allocationCount.load(std::memory_order_relaxed);
+    stats.bytes = allocationBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+#else
+
+bool isAllocationTrackingEnabled() {
+    return false;
+}
+
+AllocationStats getAllocationStats() {
+    return AllocationStats();
+}
+
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts every global operator new when the game is built with HYPERSONIC_TRACK_ALLOCATIONS
+// (the CMake option of the same name). Take a snapshot at the start of a frame and subtract it
+// from one taken at the end to see what the frame allocated.
+struct AllocationStats {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+};
+
+bool isAllocationTrackingEnabled();
+
+// Totals since the program started. Always zero when tracking is compiled out.
+AllocationStats getAllocationStats();
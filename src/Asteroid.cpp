@@ -1,21 +1,251 @@
 #include "./Asteroid.hpp"
+#include "./MeshBvh.hpp"
 #include "../libs/raylib/src/raymath.h"
 
-Asteroid::Asteroid(Model model, Vector3 position, Vector3 velocity) {
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// ==================================================================================
+// CPU copy of the displacement in assets/shaders/glsl*/asteroid.vs, for collisions. Small
+// float differences from the GPU don't matter.
+// ==================================================================================
+
+static const float ShapeAmplitude = 0.35f;
+static const float ShapeFrequency = 2.5f;
+static const float MaxShapeScale = 1 + ShapeAmplitude;
+
+// Segments are bent to follow the displacement in pieces no longer than this, in model space.
+static const float SegmentPieceLength = 0.25f;
+static const int MaxSegmentPieces = 32;
+
+static int shapeSeedLocation = -1;
+static int wireColorLocation = -1;
+
+static float fract(float value) {
+    return value - floorf(value);
+}
+
+// Hash without sine
+static float hash13(Vector3 p) {
+    p = { fract(p.x * 0.1031f), fract(p.y * 0.1031f), fract(p.z * 0.1031f) };
+    float d = p.x * (p.z + 31.32f) + p.y * (p.y + 31.32f) + p.z * (p.x + 31.32f);
+    p = { p.x + d, p.y + d, p.z + d };
+    return fract((p.x + p.y) * p.z);
+}
+
+static float valueNoise(Vector3 p) {
+    Vector3 i = { floorf(p.x), floorf(p.y), floorf(p.z) };
+    Vector3 f = { p.x - i.x, p.y - i.y, p.z - i.z };
+    f = { f.x * f.x * (3 - 2 * f.x), f.y * f.y * (3 - 2 * f.y), f.z * f.z * (3 - 2 * f.z) };
+
+    float n000 = hash13(i);
+    float n100 = hash13({ i.x + 1, i.y, i.z });
+    float n010 = hash13({ i.x, i.y + 1, i.z });
+    float n110 = hash13({ i.x + 1, i.y + 1, i.z });
+    float n001 = hash13({ i.x, i.y, i.z + 1 });
+    float n101 = hash13({ i.x + 1, i.y, i.z + 1 });
+    float n011 = hash13({ i.x, i.y + 1, i.z + 1 });
+    float n111 = hash13({ i.x + 1, i.y + 1, i.z + 1 });
+
+    float n = Lerp(Lerp(Lerp(n000, n100, f.x), Lerp(n010, n110, f.x), f.y),
+                   Lerp(Lerp(n001, n101, f.x), Lerp(n011, n111, f.x), f.y), f.z);
+    return n * 2 - 1;
+}
+
+// How far the surface is pushed out (above 1) or in along `direction`.
+static float shapeScale(Vector3 direction, float seed) {
+    Vector3 offset = { seed * 0.618f, seed * 0.382f + 17, seed * 0.277f + 41 };
+    Vector3 p = Vector3Add(Vector3Scale(direction, ShapeFrequency), offset);
+    return 1 + ShapeAmplitude * valueNoise(p);
+}
+
+// Average of the shape over evenly spread directions, so the collision sphere fits the shape.
+static float averageShapeScale(int seed) {
+    const int samples = 48;
+    const float goldenAngle = PI * (3 - sqrtf(5));
+
+    float total = 0;
+    for (int i = 0; i < samples; ++i) {
+        float y = 1 - (i + 0.5f) * 2 / samples;
+        float ring = sqrtf(1 - y * y);
+        float angle = goldenAngle * i;
+        total += shapeScale({ cosf(angle) * ring, y, sinf(angle) * ring }, (float)seed);
+    }
+
+    return total / samples;
+}
+
+// Undoes the displacement, moving a point on the drawn shape onto the mesh. Asteroids are
+// roughly round, so every direction from the center crosses the surface once.
+static Vector3 undisplace(Vector3 point, float seed) {
+    float length = Vector3Length(point);
+    if (length < 1e-6f)
+        return point;
+    return Vector3Scale(point, 1 / shapeScale(Vector3Scale(point, 1 / length), seed));
+}
+
+static Vector3 closestPointOnSegment(Vector3 point, Vector3 from, Vector3 to) {
+    Vector3 segment = Vector3Subtract(to, from);
+    float lengthSqr = Vector3LengthSqr(segment);
+    if (lengthSqr < 1e-12f)
+        return from;
+
+    float t = Clamp(Vector3DotProduct(Vector3Subtract(point, from), segment) / lengthSqr, 0, 1);
+    return Vector3Add(from, Vector3Scale(segment, t));
+}
+
+// The model is drawn rotated by its transform, then scaled and moved to the position.
+static Vector3 toModelSpace(const Asteroid& asteroid, Vector3 point) {
+    Vector3 local = Vector3Scale(Vector3Subtract(point, asteroid.position), 1 / asteroid.scale);
+    return Vector3Transform(local, MatrixTranspose(asteroid.model.transform));
+}
+
+// Gives every triangle its own three vertices, with barycentric coordinates in the second
+// texture coordinates, so the shader knows how close each pixel is to an edge. Vertices that
+// shared a position still do, so the shape shader moves them together. Only the attributes the
+// asteroid uses are kept.
+static void bakeBarycentrics(Mesh& mesh) {
+    static const float corners[3][2] = { { 1, 0 }, { 0, 1 }, { 0, 0 } };
+
+    if (mesh.texcoords2)
+        return;
+
+    Mesh baked = {};
+    baked.triangleCount = mesh.triangleCount;
+    baked.vertexCount = mesh.triangleCount * 3;
+    baked.vertices = (float*)MemAlloc(baked.vertexCount * 3 * sizeof(float));
+    baked.texcoords2 = (float*)MemAlloc(baked.vertexCount * 2 * sizeof(float));
+    if (mesh.normals)
+        baked.normals = (float*)MemAlloc(baked.vertexCount * 3 * sizeof(float));
+    if (mesh.texcoords)
+        baked.texcoords = (float*)MemAlloc(baked.vertexCount * 2 * sizeof(float));
+    if (mesh.colors)
+        baked.colors = (unsigned char*)MemAlloc(baked.vertexCount * 4);
+
+    for (int i = 0; i < baked.vertexCount; ++i) {
+        int source = mesh.indices ? mesh.indices[i] : i;
+        memcpy(&baked.vertices[i * 3], &mesh.vertices[source * 3], 3 * sizeof(float));
+        memcpy(&baked.texcoords2[i * 2], corners[i % 3], 2 * sizeof(float));
+        if (mesh.normals)
+            memcpy(&baked.normals[i * 3], &mesh.normals[source * 3], 3 * sizeof(float));
+        if (mesh.texcoords)
+            memcpy(&baked.texcoords[i * 2], &mesh.texcoords[source * 2], 2 * sizeof(float));
+        if (mesh.colors)
+            memcpy(&baked.colors[i * 4], &mesh.colors[source * 4], 4);
+    }
+
+    UploadMesh(&baked, false);
+    UnloadMesh(mesh);
+    mesh = baked;
+}
+
+Asteroid::Asteroid() {}
+
+Asteroid::Asteroid(Model model, Vector3 position, Vector3 velocity, Vector3 rotation, int shapeSeed) {
     this->position = position;
     this->velocity = velocity;
     this->model = model;
-    Vector3 rotation;
-    rotation.x = GetRandomValue(1, 7);
-    rotation.y = GetRandomValue(1, 7);
-    rotation.z = GetRandomValue(1, 7);
+    this->rotation = rotation;
     this->model.transform = MatrixRotateXYZ(rotation);
     this->scale = 0;
+    this->shapeSeed = shapeSeed;
+    this->radius = averageShapeScale(shapeSeed);
 }
 
-void Asteroid::draw() {
+void Asteroid::setShapeShader(Model& model, Shader shader) {
+    model.materials[0].shader = shader;
+    shapeSeedLocation = GetShaderLocation(shader, "shapeSeed");
+
+    // Shaders that can draw the edges themselves save drawing every asteroid a second time.
+    wireColorLocation = GetShaderLocation(shader, "wireColor");
+    if (wireColorLocation >= 0) {
+        for (int i = 0; i < model.meshCount; ++i)
+            bakeBarycentrics(model.meshes[i]);
+
+        Vector4 wireColor = ColorNormalize(GRAY);
+        SetShaderValue(shader, wireColorLocation, &wireColor, SHADER_UNIFORM_VEC4);
+    }
+}
+
+float Asteroid::getCollisionRadius() const {
+    return radius * scale;
+}
+
+bool Asteroid::isHitBySegment(const MeshBvh* bvh, Vector3 from, Vector3 to) const {
+    if (scale <= 0)
+        return false;
+
+    if (!bvh) {
+        float reach = getCollisionRadius();
+        return Vector3DistanceSqr(closestPointOnSegment(position, from, to), position) < reach * reach;
+    }
+
+    Vector3 start = toModelSpace(*this, from);
+    Vector3 end = toModelSpace(*this, to);
+    float reach = bvh->getBoundingRadius() * MaxShapeScale;
+    if (Vector3LengthSqr(closestPointOnSegment(Vector3Zero(), start, end)) > reach * reach)
+        return false;
+
+    // The displacement bends straight lines, so the segment is followed in short pieces.
+    float seed = (float)shapeSeed;
+    int pieces = (int)ceilf(Vector3Distance(start, end) / SegmentPieceLength);
+    pieces = std::max(1, std::min(pieces, MaxSegmentPieces));
+
+    Vector3 previous = undisplace(start, seed);
+    for (int i = 1; i <= pieces; ++i) {
+        Vector3 next = undisplace(Vector3Lerp(start, end, (float)i / pieces), seed);
+        Vector3 piece = Vector3Subtract(next, previous);
+        float length = Vector3Length(piece);
+
+        float hitDistance;
+        if (length > 1e-6f && bvh->raycast(previous, Vector3Scale(piece, 1 / length), length, hitDistance))
+            return true;
+
+        previous = next;
+    }
+
+    return false;
+}
+
+bool Asteroid::isHitBySphere(const MeshBvh* bvh, Vector3 center, float sphereRadius) const {
+    if (scale <= 0)
+        return false;
+
+    if (!bvh) {
+        float reach = getCollisionRadius() + sphereRadius;
+        return Vector3DistanceSqr(center, position) < reach * reach;
+    }
+
+    Vector3 local = toModelSpace(*this, center);
+    float localRadius = sphereRadius / scale;
+    float reach = bvh->getBoundingRadius() * MaxShapeScale + localRadius;
+    float lengthSqr = Vector3LengthSqr(local);
+    if (lengthSqr > reach * reach)
+        return false;
+
+    // Distances near the surface shrink by about as much as the point was pulled in.
+    Vector3 point = undisplace(local, (float)shapeSeed);
+    float shrink = lengthSqr > 1e-12f ? Vector3Length(point) / sqrtf(lengthSqr) : 1;
+
+    Vector3 closest;
+    Vector3 normal;
+    if (bvh->closestPoint(point, localRadius * shrink, closest, normal))
+        return true;
+
+    // Further from the surface than the radius, but it could still be inside.
+    return bvh->contains(point);
+}
+
+void Asteroid::draw() const {
+    if (shapeSeedLocation >= 0) {
+        float seed = (float)shapeSeed;
+        SetShaderValue(model.materials[0].shader, shapeSeedLocation, &seed, SHADER_UNIFORM_FLOAT);
+    }
+
     DrawModel(this->model, this->position, this->scale, {68, 68, 68, 225});
-    DrawModelWires(this->model, this->position, this->scale, GRAY);
+    if (wireColorLocation < 0)
+        DrawModelWires(this->model, this->position, this->scale, GRAY);
 }
 
 void Asteroid::update(float deltaTime) {
@@ -27,3 +257,24 @@ void Asteroid::update(float deltaTime) {
         this->scale += deltaTime * 0.7;
     }
 }
+
+void Asteroid::saveState(StateWriter& writer) const {
+    writer.write(position);
+    writer.write(velocity);
+    writer.write(rotation);
+    writer.write(scale);
+    writer.write(shapeSeed);
+    writer.write(radius);
+    writer.write(isDead);
+}
+
+void Asteroid::loadState(StateReader& reader) {
+    reader.read(position);
+    reader.read(velocity);
+    reader.read(rotation);
+    reader.read(scale);
+    reader.read(shapeSeed);
+    reader.read(radius);
+    reader.read(isDead);
+    model.transform = MatrixRotateXYZ(rotation);
+}
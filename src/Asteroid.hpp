@@ -1,18 +1,48 @@
 #pragma once
 
 #include "./Entity.hpp"
+#include "./State.hpp"
 #include "../libs/raylib/src/raylib.h"
 
+class MeshBvh;
+
+// Shape seeds run from 0 to this, exclusive.
+static const int AsteroidShapeSeeds = 1024;
 
 class Asteroid : public Entity {
     public:
+        // Collision radius at a scale of 1. Worked out from the shape seed.
         float radius = 1;
         int rings = 5;
         int slices = 4;
         float scale = 0;
         bool isDead = false;
         Model model;
-        Asteroid(Model model, Vector3 position, Vector3 velocity);
-        void draw();
+        // Euler angles the model is rotated by.
+        Vector3 rotation;
+        // Picks how the shape shader deforms the shared mesh for this asteroid.
+        int shapeSeed = 0;
+        // Only for preallocated storage. Assign a real asteroid before using it.
+        Asteroid();
+        Asteroid(Model model, Vector3 position, Vector3 velocity, Vector3 rotation, int shapeSeed);
+        void draw() const;
         void update(float deltaTime);
+
+        float getCollisionRadius() const;
+
+        // Tests against the shape as the shader draws it. `bvh` is built from the undeformed
+        // model mesh. Without one, as on the server, which loads no models, these test against
+        // the collision sphere instead.
+        bool isHitBySegment(const MeshBvh* bvh, Vector3 from, Vector3 to) const;
+        bool isHitBySphere(const MeshBvh* bvh, Vector3 center, float sphereRadius) const;
+
+        // Makes every asteroid drawn with `model` deform it by its own shape seed. All copies of a
+        // model share its materials, so this only has to be done once. If the shader draws the
+        // edges too (it has a `wireColor` uniform) the mesh is rebuilt with what that needs, so
+        // call this before building anything from the mesh.
+        static void setShapeShader(Model& model, Shader shader);
+
+        // The model isn't saved. Loading only rebuilds its transform.
+        void saveState(StateWriter& writer) const;
+        void loadState(StateReader& reader);
 };
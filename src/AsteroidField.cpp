@@ -0,0 +1,316 @@
+#include "AsteroidField.hpp"
+
+#include "../libs/raylib/src/raymath.h"
+
+#include "Random.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+static const float ChunkSize = 50;
+static const int LoadRadius = 2;
+
+// Every chunk in range, plus some slack for queued chunks that went out of range before the
+// worker got to them.
+static const int ChunkBudget = (2 * LoadRadius + 1) * (2 * LoadRadius + 1) * (2 * LoadRadius + 1) + 32;
+
+static const float MinAsteroidScale = 1;
+static const float MaxAsteroidScale = 3;
+
+bool ChunkCoord::operator==(const ChunkCoord& other) const {
+    return x == other.x && y == other.y && z == other.z;
+}
+
+bool ChunkCoord::operator!=(const ChunkCoord& other) const {
+    return !(*this == other);
+}
+
+static ChunkCoord chunkAt(Vector3 position) {
+    return ChunkCoord{
+        (int32_t)floorf(position.x / ChunkSize),
+        (int32_t)floorf(position.y / ChunkSize),
+        (int32_t)floorf(position.z / ChunkSize)
+    };
+}
+
+static int chunkDistance(ChunkCoord a, ChunkCoord b) {
+    return std::max(abs(a.x - b.x), std::max(abs(a.y - b.y), abs(a.z - b.z)));
+}
+
+// splitmix64's finalizer. Neighbouring coordinates end up with unrelated seeds.
+static uint64_t mix(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+AsteroidField::Chunk::Chunk() : state(FREE), count(0), alive(0) {}
+
+AsteroidField::AsteroidField(Model model, uint64_t seed) : chunks(ChunkBudget), queue(ChunkBudget) {
+    this->model = model;
+    this->seed = seed;
+
+    for (int x = -LoadRadius; x <= LoadRadius; ++x) {
+        for (int y = -LoadRadius; y <= LoadRadius; ++y) {
+            for (int z = -LoadRadius; z <= LoadRadius; ++z) {
+                offsets.push_back(ChunkCoord{ x, y, z });
+            }
+        }
+    }
+
+    std::stable_sort(offsets.begin(), offsets.end(), [](const ChunkCoord& a, const ChunkCoord& b) {
+        return a.x * a.x + a.y * a.y + a.z * a.z < b.x * b.x + b.y * b.y + b.z * b.z;
+    });
+
+#if !defined(__EMSCRIPTEN__)
+    worker = std::thread(&AsteroidField::runWorker, this);
+#endif
+}
+
+AsteroidField::~AsteroidField() {
+#if !defined(__EMSCRIPTEN__)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+#endif
+}
+
+void AsteroidField::update(Vector3 viewPosition) {
+    ChunkCoord newCenter = chunkAt(viewPosition);
+    if (newCenter != center) {
+        center = newCenter;
+        needsScan = true;
+    }
+
+    // Pick up finished chunks and free the ones that are out of range. Queued chunks belong to
+    // the worker until they're ready, so those are freed on a later update.
+    for (auto& chunk : chunks) {
+        int state = chunk.state.load(std::memory_order_acquire);
+
+        if (state == READY) {
+            applyDestroyed(chunk);
+            chunk.state.store(LIVE, std::memory_order_relaxed);
+            state = LIVE;
+        }
+
+        if (state == LIVE && chunkDistance(chunk.coord, center) > LoadRadius) {
+            chunk.state.store(FREE, std::memory_order_relaxed);
+            needsScan = true;
+        }
+    }
+
+    if (!needsScan)
+        return;
+
+    needsScan = false;
+    int freeIndex = 0;
+    for (auto& offset : offsets) {
+        ChunkCoord coord = { center.x + offset.x, center.y + offset.y, center.z + offset.z };
+        if (findChunk(coord) >= 0)
+            continue;
+
+        while (freeIndex < (int)chunks.size()
+               && chunks[freeIndex].state.load(std::memory_order_relaxed) != FREE)
+            freeIndex++;
+
+        // Out of slots until the queued chunks that went out of range come back and get freed.
+        if (freeIndex == (int)chunks.size()) {
+            needsScan = true;
+            break;
+        }
+
+        request(freeIndex, coord);
+    }
+}
+
+int AsteroidField::findChunk(ChunkCoord coord) const {
+    for (int i = 0; i < (int)chunks.size(); ++i) {
+        if (chunks[i].state.load(std::memory_order_relaxed) != FREE && chunks[i].coord == coord)
+            return i;
+    }
+    return -1;
+}
+
+void AsteroidField::request(int index, ChunkCoord coord) {
+    Chunk& chunk = chunks[index];
+    chunk.coord = coord;
+
+#if defined(__EMSCRIPTEN__)
+    generate(chunk);
+    applyDestroyed(chunk);
+    chunk.state.store(LIVE, std::memory_order_relaxed);
+#else
+    chunk.state.store(QUEUED, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue[(queueHead + queueCount) % queue.size()] = index;
+        queueCount++;
+    }
+    wake.notify_one();
+#endif
+}
+
+void AsteroidField::runWorker() {
+    for (;;) {
+        int index;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || queueCount > 0; });
+            if (stopping)
+                return;
+
+            index = queue[queueHead];
+            queueHead = (queueHead + 1) % queue.size();
+            queueCount--;
+        }
+
+        generate(chunks[index]);
+        chunks[index].state.store(READY, std::memory_order_release);
+    }
+}
+
+void AsteroidField::generate(Chunk& chunk) const {
+    ChunkCoord coord = chunk.coord;
+    Random random(mix(seed ^ mix((uint32_t)coord.x ^ mix((uint32_t)coord.y ^ mix((uint32_t)coord.z)))));
+
+    // Asteroids are kept fully inside their chunk, so hit tests only need to look in the chunks
+    // they touch. Their shapes stick out to about 1.35 times their scale.
+    Vector3 origin = { coord.x * ChunkSize, coord.y * ChunkSize, coord.z * ChunkSize };
+    float low = MaxAsteroidScale * 1.5f;
+    float high = ChunkSize - low;
+
+    chunk.count = random.range(0, maxAsteroidsPerChunk);
+    for (int i = 0; i < chunk.count; ++i) {
+        Vector3 position = {
+            origin.x + random.rangeFloat(low, high),
+            origin.y + random.rangeFloat(low, high),
+            origin.z + random.rangeFloat(low, high)
+        };
+
+        Vector3 rotation;
+        rotation.x = random.range(1, 7);
+        rotation.y = random.range(1, 7);
+        rotation.z = random.range(1, 7);
+
+        int shapeSeed = random.range(0, AsteroidShapeSeeds - 1);
+        chunk.asteroids[i] = Asteroid(model, position, Vector3Zero(), rotation, shapeSeed);
+        chunk.asteroids[i].scale = random.rangeFloat(MinAsteroidScale, MaxAsteroidScale);
+    }
+
+    chunk.alive = (uint16_t)((1 << chunk.count) - 1);
+}
+
+void AsteroidField::applyDestroyed(Chunk& chunk) const {
+    chunk.alive = (uint16_t)((1 << chunk.count) - 1);
+    for (int i = 0; i < destroyedCount; ++i) {
+        if (destroyed[i].chunk == chunk.coord)
+            chunk.alive &= (uint16_t)~(1 << destroyed[i].index);
+    }
+}
+
+template <typename Test>
+bool AsteroidField::findAsteroid(Vector3 min, Vector3 max, Test test, int& chunkIndex, int& asteroidIndex) const {
+    // Asteroids are inside their chunk, so only the chunks the box touches can have a hit.
+    ChunkCoord low = chunkAt(min);
+    ChunkCoord high = chunkAt(max);
+
+    for (int32_t x = low.x; x <= high.x; ++x) {
+        for (int32_t y = low.y; y <= high.y; ++y) {
+            for (int32_t z = low.z; z <= high.z; ++z) {
+                int index = findChunk(ChunkCoord{ x, y, z });
+                if (index < 0 || chunks[index].state.load(std::memory_order_relaxed) != LIVE)
+                    continue;
+
+                const Chunk& chunk = chunks[index];
+                for (int i = 0; i < chunk.count; ++i) {
+                    if (!(chunk.alive & (1 << i)))
+                        continue;
+
+                    testCount++;
+                    if (test(chunk.asteroids[i])) {
+                        chunkIndex = index;
+                        asteroidIndex = i;
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+bool AsteroidField::destroyHitBy(const MeshBvh* bvh, Vector3 from, Vector3 to, Asteroid* hitAsteroid) {
+    int chunkIndex;
+    int asteroidIndex;
+    bool hit = findAsteroid(Vector3Min(from, to), Vector3Max(from, to), [&](const Asteroid& asteroid) {
+        return asteroid.isHitBySegment(bvh, from, to);
+    }, chunkIndex, asteroidIndex);
+
+    if (!hit)
+        return false;
+
+    Chunk& chunk = chunks[chunkIndex];
+    chunk.alive &= (uint16_t)~(1 << asteroidIndex);
+    if (hitAsteroid)
+        *hitAsteroid = chunk.asteroids[asteroidIndex];
+
+    destroyed[destroyedNext] = DestroyedAsteroid{ chunk.coord, asteroidIndex };
+    destroyedNext = (destroyedNext + 1) % maxDestroyed;
+    destroyedCount = std::min(destroyedCount + 1, maxDestroyed);
+    return true;
+}
+
+bool AsteroidField::isHitBySphere(const MeshBvh* bvh, Vector3 center, float radius) const {
+    Vector3 extent = { radius, radius, radius };
+    int chunkIndex;
+    int asteroidIndex;
+    return findAsteroid(Vector3Subtract(center, extent), Vector3Add(center, extent), [&](const Asteroid& asteroid) {
+        return asteroid.isHitBySphere(bvh, center, radius);
+    }, chunkIndex, asteroidIndex);
+}
+
+int AsteroidField::getTestCount() const {
+    return testCount;
+}
+
+void AsteroidField::resetTestCount() {
+    testCount = 0;
+}
+
+int AsteroidField::getLoadedChunkCount() const {
+    int count = 0;
+    for (auto& chunk : chunks) {
+        if (chunk.state.load(std::memory_order_relaxed) == LIVE)
+            count++;
+    }
+    return count;
+}
+
+int AsteroidField::getMaxAsteroidCount() const {
+    return (int)chunks.size() * maxAsteroidsPerChunk;
+}
+
+void AsteroidField::saveState(StateWriter& writer) const {
+    writer.write(destroyedCount);
+    writer.write(destroyedNext);
+    writer.writeBytes(destroyed, sizeof(DestroyedAsteroid) * destroyedCount);
+}
+
+void AsteroidField::loadState(StateReader& reader) {
+    reader.read(destroyedCount);
+    reader.read(destroyedNext);
+    if (destroyedCount < 0 || destroyedCount > maxDestroyed)
+        destroyedCount = 0;
+    reader.readBytes(destroyed, sizeof(DestroyedAsteroid) * destroyedCount);
+
+    for (auto& chunk : chunks) {
+        if (chunk.state.load(std::memory_order_relaxed) == LIVE)
+            applyDestroyed(chunk);
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "../libs/raylib/src/raylib.h"
+
+#include "Asteroid.hpp"
+#include "MeshBvh.hpp"
+#include "State.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ChunkCoord {
+    int32_t x;
+    int32_t y;
+    int32_t z;
+
+    bool operator==(const ChunkCoord& other) const;
+    bool operator!=(const ChunkCoord& other) const;
+};
+
+// An endless field of still asteroids. Space is split into cubic chunks whose contents come from
+// a hash of the chunk's coordinates, so a chunk can be thrown away when the player leaves it and
+// rebuilt identically when they come back. Chunks are generated on a worker thread (inline on
+// the web, which has no threads) into a fixed pool of slots, so memory use never grows.
+class AsteroidField {
+    public:
+        AsteroidField(Model model, uint64_t seed);
+        ~AsteroidField();
+
+        // Frees chunks that are out of range and queues the missing ones, nearest first.
+        void update(Vector3 viewPosition);
+
+        // Destroys the first asteroid the segment hits, if any. Destroyed asteroids stay destroyed
+        // when their chunk is regenerated, up to a limit after which the oldest ones come back.
+        // See Asteroid::isHitBySegment for `bvh`. The destroyed asteroid is copied to `hitAsteroid`
+        // if that isn't null.
+        bool destroyHitBy(const MeshBvh* bvh, Vector3 from, Vector3 to, Asteroid* hitAsteroid = nullptr);
+
+        bool isHitBySphere(const MeshBvh* bvh, Vector3 center, float radius) const;
+
+        // Calls `visit` with every asteroid in the chunks that are ready.
+        template <typename Visitor>
+        void forEachAsteroid(Visitor visit) const {
+            for (auto& chunk : chunks) {
+                if (chunk.state.load(std::memory_order_relaxed) != LIVE)
+                    continue;
+
+                for (int i = 0; i < chunk.count; ++i) {
+                    if (chunk.alive & (1 << i))
+                        visit(chunk.asteroids[i]);
+                }
+            }
+        }
+
+        int getLoadedChunkCount() const;
+
+        // Most asteroids forEachAsteroid() can visit, for sizing lists.
+        int getMaxAsteroidCount() const;
+
+        // Asteroids tested for hits since the count was last reset.
+        int getTestCount() const;
+        void resetTestCount();
+
+        // Only the destroyed asteroids are saved. Everything else can be regenerated.
+        void saveState(StateWriter& writer) const;
+        void loadState(StateReader& reader);
+
+    private:
+        static const int maxAsteroidsPerChunk = 6;
+        static const int maxDestroyed = 256;
+
+        enum ChunkState { FREE, QUEUED, READY, LIVE };
+
+        struct Chunk {
+            ChunkCoord coord;
+            std::atomic<int> state;
+            int count;
+            uint16_t alive;
+            Asteroid asteroids[maxAsteroidsPerChunk];
+
+            Chunk();
+        };
+
+        struct DestroyedAsteroid {
+            ChunkCoord chunk;
+            int32_t index;
+        };
+
+        Model model;
+        uint64_t seed;
+        std::vector<Chunk> chunks;
+
+        // Chunk offsets within the load radius, nearest first.
+        std::vector<ChunkCoord> offsets;
+        ChunkCoord center = { 0, 0, 0 };
+        bool needsScan = true;
+        mutable int testCount = 0;
+
+        DestroyedAsteroid destroyed[maxDestroyed];
+        int destroyedCount = 0;
+        int destroyedNext = 0;
+
+        // Work queue of chunk indices for the generator thread.
+        std::thread worker;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::vector<int> queue;
+        int queueHead = 0;
+        int queueCount = 0;
+        bool stopping = false;
+
+        int findChunk(ChunkCoord coord) const;
+
+        // Looks through the live chunks overlapping the box from `min` to `max` for an asteroid
+        // that passes `test`.
+        template <typename Test>
+        bool findAsteroid(Vector3 min, Vector3 max, Test test, int& chunkIndex, int& asteroidIndex) const;
+        void request(int index, ChunkCoord coord);
+        void generate(Chunk& chunk) const;
+        void applyDestroyed(Chunk& chunk) const;
+        void runWorker();
+
+        AsteroidField(const AsteroidField&);
+        AsteroidField& operator=(const AsteroidField&);
+};
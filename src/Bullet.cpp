@@ -11,7 +11,7 @@ Bullet::Bullet(bool enemy, Color color, Vector3 position, Vector3 velocity) {
     this->isEnemy = enemy;
 }
 
-void Bullet::draw() {
+void Bullet::draw() const {
     DrawCylinderEx(this->position,
                    Vector3Add(this->position, Vector3Scale(Vector3Normalize(this->velocity), 2)),
                    0, 0.09, 1, this->color);
@@ -26,3 +26,21 @@ void Bullet::update(float deltaTime) {
     }
 }
 
+void Bullet::saveState(StateWriter& writer) const {
+    writer.write(position);
+    writer.write(velocity);
+    writer.write(timeElapsed);
+    writer.write(color);
+    writer.write(isEnemy);
+    writer.write(isDead);
+}
+
+void Bullet::loadState(StateReader& reader) {
+    reader.read(position);
+    reader.read(velocity);
+    reader.read(timeElapsed);
+    reader.read(color);
+    reader.read(isEnemy);
+    reader.read(isDead);
+}
+
@@ -2,13 +2,16 @@
 
 #include "../libs/raylib/src/raylib.h"
 #include "./Entity.hpp"
+#include "./State.hpp"
 
 class Bullet : public Entity {
     public:
         bool isDead;
         Bullet(bool enemy, Color color, Vector3 position, Vector3 velocity);
-        void draw();
+        void draw() const;
         void update(float deltaTime);
+        void saveState(StateWriter& writer) const;
+        void loadState(StateReader& reader);
         float timeElapsed;
         bool isEnemy;
         Color color;
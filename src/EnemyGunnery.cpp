@@ -0,0 +1,109 @@
+#include "EnemyGunnery.hpp"
+
+#include "../libs/raylib/src/raymath.h"
+
+#include "Ship.hpp"
+#include "SimdMath.hpp"
+
+EnemyGunnery::EnemyGunnery(int capacity) {
+    resize((capacity + 3) & ~3);
+}
+
+void EnemyGunnery::resize(int size) {
+    offsetX.resize(size);
+    offsetY.resize(size);
+    offsetZ.resize(size);
+    forwardX.resize(size);
+    forwardY.resize(size);
+    forwardZ.resize(size);
+    aimX.resize(size);
+    aimY.resize(size);
+    aimZ.resize(size);
+    flightTime.resize(size);
+    aimAlong.resize(size);
+    aimDistanceSqr.resize(size);
+}
+
+void EnemyGunnery::aim(const std::vector<Ship>& enemies, const Ship& target) {
+    count = (int)enemies.size();
+    int padded = (count + 3) & ~3;
+    if ((int)offsetX.size() < padded)
+        resize(padded);
+
+    for (int i = 0; i < count; ++i) {
+        const Ship& enemy = enemies[i];
+        Vector3 forward = enemy.getForward();
+        offsetX[i] = target.position.x - enemy.position.x;
+        offsetY[i] = target.position.y - enemy.position.y;
+        offsetZ[i] = target.position.z - enemy.position.z;
+        forwardX[i] = forward.x;
+        forwardY[i] = forward.y;
+        forwardZ[i] = forward.z;
+    }
+
+    // Padding lanes aim at something straight ahead, so they never work on garbage.
+    for (int i = count; i < padded; ++i) {
+        offsetX[i] = offsetY[i] = 0;
+        offsetZ[i] = 1;
+        forwardX[i] = forwardY[i] = 0;
+        forwardZ[i] = 1;
+    }
+
+    // |offset + v t| = s t, where v is the target's velocity and s the bullet speed, gives
+    // a t^2 + 2 b t + c = 0 with a = v.v - s^2, b = offset.v and c = offset.offset. Every enemy
+    // has the same a. While it's negative the roots have opposite signs, and the one ahead is
+    // (b + sqrt(b^2 - a c)) / -a. A target as fast as the bullets could outrun them, so a is
+    // kept negative. Those shots come out too long to pass the flight time test anyway.
+    Vector3 velocity = target.velocity;
+    float speedSqr = bulletSpeed * bulletSpeed;
+    float a = fminf(Vector3DotProduct(velocity, velocity) - speedSqr, -0.01f * speedSqr);
+
+    Float4 negativeA = splatFloat4(-a);
+    Float4 inverseNegativeA = splatFloat4(-1 / a);
+    Float4 vx = splatFloat4(velocity.x);
+    Float4 vy = splatFloat4(velocity.y);
+    Float4 vz = splatFloat4(velocity.z);
+
+    for (int i = 0; i < padded; i += 4) {
+        Float4 dx = loadFloat4(&offsetX[i]);
+        Float4 dy = loadFloat4(&offsetY[i]);
+        Float4 dz = loadFloat4(&offsetZ[i]);
+
+        Float4 b = add4(add4(mul4(dx, vx), mul4(dy, vy)), mul4(dz, vz));
+        Float4 c = add4(add4(mul4(dx, dx), mul4(dy, dy)), mul4(dz, dz));
+        Float4 t = mul4(add4(b, sqrt4(add4(mul4(b, b), mul4(negativeA, c)))), inverseNegativeA);
+
+        Float4 ax = add4(dx, mul4(vx, t));
+        Float4 ay = add4(dy, mul4(vy, t));
+        Float4 az = add4(dz, mul4(vz, t));
+        storeFloat4(&aimX[i], ax);
+        storeFloat4(&aimY[i], ay);
+        storeFloat4(&aimZ[i], az);
+        storeFloat4(&flightTime[i], t);
+
+        Float4 along = add4(add4(mul4(ax, loadFloat4(&forwardX[i])), mul4(ay, loadFloat4(&forwardY[i]))),
+                            mul4(az, loadFloat4(&forwardZ[i])));
+        storeFloat4(&aimAlong[i], along);
+        storeFloat4(&aimDistanceSqr[i], add4(add4(mul4(ax, ax), mul4(ay, ay)), mul4(az, az)));
+    }
+
+    float coneCosine = cosf(coneAngle * DEG2RAD);
+    coneCosineSqr = coneCosine * coneCosine;
+}
+
+bool EnemyGunnery::hasShot(int enemy) const {
+    float time = flightTime[enemy];
+    float along = aimAlong[enemy];
+    return time > 0 && time <= maxFlightTime
+        && along > 0 && along * along >= coneCosineSqr * aimDistanceSqr[enemy];
+}
+
+Vector3 EnemyGunnery::getBulletVelocity(int enemy) const {
+    // The aim point is bullet speed times flight time away, so this has that speed.
+    float inverseTime = 1 / flightTime[enemy];
+    return { aimX[enemy] * inverseTime, aimY[enemy] * inverseTime, aimZ[enemy] * inverseTime };
+}
+
+int EnemyGunnery::getCount() const {
+    return count;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../libs/raylib/src/raylib.h"
+
+#include <vector>
+
+class Ship;
+
+// Lead targeting for every enemy at once. Where each enemy has to shoot to hit a target flying
+// at a constant velocity is the smaller positive root of a quadratic. The enemies are copied into
+// one array per field (structure of arrays) so it's solved for four of them at a time. Nothing
+// here is saved, it's worked out again every tick.
+class EnemyGunnery {
+    public:
+        // Speed of the bullets the enemies fire.
+        float bulletSpeed = 100;
+        // Longest a shot can take to reach the target. Bullets live for a second.
+        float maxFlightTime = 0.9f;
+        // How far off its nose, in degrees, an enemy will shoot.
+        float coneAngle = 20;
+
+        // Room for `capacity` enemies. More can be aimed, but then the arrays grow.
+        EnemyGunnery(int capacity);
+
+        // Works out where each of `enemies` has to shoot to hit `target`. The results are by
+        // index into `enemies`, until the next call.
+        void aim(const std::vector<Ship>& enemies, const Ship& target);
+
+        // Whether the shot is inside the enemy's cone and the bullet gets there in time.
+        bool hasShot(int enemy) const;
+
+        // What a bullet fired now has to fly at to meet the target.
+        Vector3 getBulletVelocity(int enemy) const;
+
+        int getCount() const;
+
+    private:
+        // Arrays are padded to a multiple of four so the solve never needs a scalar tail.
+        int count = 0;
+
+        // From the enemy to the target.
+        std::vector<float> offsetX;
+        std::vector<float> offsetY;
+        std::vector<float> offsetZ;
+        // The enemy's forward direction.
+        std::vector<float> forwardX;
+        std::vector<float> forwardY;
+        std::vector<float> forwardZ;
+
+        // Where the target will be when the bullet reaches it, from the enemy.
+        std::vector<float> aimX;
+        std::vector<float> aimY;
+        std::vector<float> aimZ;
+        std::vector<float> flightTime;
+        // How far the aim point is along the enemy's forward direction, and its squared
+        // distance, for the cone test without a square root per enemy.
+        std::vector<float> aimAlong;
+        std::vector<float> aimDistanceSqr;
+        float coneCosineSqr = 0;
+
+        void resize(int size);
+};
@@ -0,0 +1,38 @@
+#include "FrameArena.hpp"
+
+FrameArena::FrameArena(size_t capacity) : memory(capacity) {}
+
+void* FrameArena::allocate(size_t size, size_t alignment) {
+    // Alignments are powers of two. The vector's own storage is aligned for any fundamental type.
+    size_t start = (used + alignment - 1) & ~(alignment - 1);
+    if (start + size > memory.size()) {
+        failures++;
+        return nullptr;
+    }
+
+    used = start + size;
+    if (used > peak)
+        peak = used;
+
+    return memory.data() + start;
+}
+
+void FrameArena::reset() {
+    used = 0;
+}
+
+size_t FrameArena::getUsed() const {
+    return used;
+}
+
+size_t FrameArena::getCapacity() const {
+    return memory.size();
+}
+
+size_t FrameArena::getPeak() const {
+    return peak;
+}
+
+int FrameArena::getFailures() const {
+    return failures;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// Linear allocator for data that only lives for one frame, like render submissions and culling
+// lists. Allocating is a pointer bump and everything is freed at once by reset(), so the frame
+// loop never has to touch the heap for transient data.
+class FrameArena {
+    public:
+        FrameArena(size_t capacity);
+
+        // Returns nullptr if the arena is full.
+        void* allocate(size_t size, size_t alignment);
+
+        template <typename T>
+        T* allocateArray(int count) {
+            static_assert(std::is_trivially_destructible<T>::value, "Arena memory is never destructed");
+            return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        // Frees everything allocated this frame.
+        void reset();
+
+        size_t getUsed() const;
+        size_t getCapacity() const;
+
+        // Most bytes used in a single frame, to size the arena with.
+        size_t getPeak() const;
+
+        // Allocations that didn't fit since the arena was created.
+        int getFailures() const;
+
+    private:
+        std::vector<uint8_t> memory;
+        size_t used = 0;
+        size_t peak = 0;
+        int failures = 0;
+};
+
+// Fixed capacity list backed by a FrameArena. It's only valid until the arena is reset.
+template <typename T>
+class FrameList {
+    public:
+        FrameList() {}
+
+        FrameList(FrameArena& arena, int capacity) {
+            static_assert(std::is_trivially_copyable<T>::value, "Frame lists only hold plain data");
+            items = arena.allocateArray<T>(capacity);
+            this->capacity = items ? capacity : 0;
+        }
+
+        // Returns false, and drops the item, if the list is full.
+        bool push(const T& item) {
+            if (count >= capacity)
+                return false;
+
+            items[count++] = item;
+            return true;
+        }
+
+        T* begin() { return items; }
+        T* end() { return items + count; }
+        const T* begin() const { return items; }
+        const T* end() const { return items + count; }
+
+        T& operator[](int index) { return items[index]; }
+        const T& operator[](int index) const { return items[index]; }
+
+        int size() const { return count; }
+
+    private:
+        T* items = nullptr;
+        int capacity = 0;
+        int count = 0;
+};
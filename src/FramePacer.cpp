@@ -0,0 +1,204 @@
+#include "FramePacer.hpp"
+
+#include "../libs/raylib/src/raylib.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+// Low latency frames plan for the slowest recent frame, plus this much.
+static const float WorkMargin = 0.001f;
+static const int WorkWindow = 8;
+
+// Without a cap, a frame counts as missed when it takes this many refresh intervals.
+static const float MissedRefreshes = 1.5f;
+
+// How often the wait callback runs while waiting.
+static const float WaitCallbackInterval = 0.001f;
+
+static std::chrono::steady_clock::duration toDuration(float seconds) {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(seconds));
+}
+
+static float toSeconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<float>(duration).count();
+}
+
+FramePacer::FramePacer(PacingMode mode, float targetFps) {
+    this->targetFps = targetFps;
+    setMode(mode);
+}
+
+void FramePacer::setMode(PacingMode mode) {
+    this->mode = mode;
+
+#if !defined(__EMSCRIPTEN__)
+    if (mode == PacingMode::VSYNC) {
+        SetWindowState(FLAG_VSYNC_HINT);
+    } else {
+        ClearWindowState(FLAG_VSYNC_HINT);
+    }
+#endif
+
+    started = false;
+    refreshRate = 0;
+    stats.missedDeadlines = 0;
+}
+
+PacingMode FramePacer::getMode() const {
+    return mode;
+}
+
+void FramePacer::setTargetFps(float fps) {
+    targetFps = std::max(fps, 0.0f);
+    started = false;
+    stats.missedDeadlines = 0;
+}
+
+float FramePacer::getTargetFps() const {
+    return targetFps;
+}
+
+void FramePacer::setBackgroundFps(float fps) {
+    backgroundFps = std::max(fps, 1.0f);
+}
+
+void FramePacer::setWaitCallback(WaitCallback callback, void* data) {
+    waitCallback = callback;
+    waitCallbackData = data;
+}
+
+void FramePacer::beginFrame() {
+    float fps = targetFps;
+    bool background = IsWindowMinimized() || !IsWindowFocused();
+    if (background && (fps <= 0 || fps > backgroundFps))
+        fps = backgroundFps;
+
+    Clock::time_point now = Clock::now();
+    Clock::time_point start = now;
+
+    if (fps <= 0) {
+        deadline = now + toDuration(MissedRefreshes / getRefreshRate());
+    } else {
+        Clock::duration period = toDuration(1 / fps);
+
+        if (mode == PacingMode::LOW_LATENCY && !background) {
+            // Keep the deadlines on a fixed beat, skipping ones that can't be made anymore, and
+            // start the frame just in time to finish by the next one.
+            Clock::duration work = toDuration(predictWorkTime());
+            deadline = started ? deadline + period : now + period;
+            while (deadline - work < now)
+                deadline += period;
+            start = deadline - work;
+        } else {
+            // A frame that ran long pushes the beat back rather than making the next ones rush.
+            start = started ? std::max(frameStart + period, now) : now;
+            deadline = start + period;
+        }
+    }
+
+#if !defined(__EMSCRIPTEN__)
+    waitUntil(start);
+#endif
+
+    Clock::time_point previousStart = frameStart;
+    frameStart = Clock::now();
+
+    if (started) {
+        frameTimes[historyNext] = toSeconds(frameStart - previousStart);
+    }
+    frameTimeFromWork = !started;
+    started = true;
+}
+
+void FramePacer::endFrame() {
+    Clock::time_point now = Clock::now();
+    if (now > deadline)
+        stats.missedDeadlines++;
+
+    workTimes[historyNext] = toSeconds(now - frameStart);
+    if (frameTimeFromWork)
+        frameTimes[historyNext] = workTimes[historyNext];
+
+    historyNext = (historyNext + 1) % historyLength;
+    historyCount = std::min(historyCount + 1, historyLength);
+    updateStats();
+}
+
+void FramePacer::waitUntil(Clock::time_point time) {
+    Clock::duration callbackInterval = toDuration(WaitCallbackInterval);
+    Clock::time_point calledAt = Clock::now() - callbackInterval;
+
+    for (;;) {
+        Clock::time_point now = Clock::now();
+        if (now >= time)
+            return;
+
+        if (waitCallback && now - calledAt >= callbackInterval) {
+            waitCallback(waitCallbackData);
+            now = calledAt = Clock::now();
+            if (now >= time)
+                return;
+        }
+
+        // Sleep for all but the last bit, then spin the rest so the wake up is on time.
+        Clock::duration remaining = time - now;
+        Clock::duration spin = toDuration(spinTime);
+        if (remaining > spin) {
+            Clock::duration request = remaining - spin;
+            if (waitCallback)
+                request = std::min(request, callbackInterval);
+            std::this_thread::sleep_for(request);
+
+            // Learn how much sleeps overshoot, forgetting slowly so one bad wake up doesn't spin
+            // for long.
+            float overshoot = toSeconds(Clock::now() - now - request);
+            spinTime = std::min(0.004f, std::max(0.0005f, std::max(overshoot * 1.25f, spinTime * 0.99f)));
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+int FramePacer::getRefreshRate() {
+    Vector2 position = GetWindowPosition();
+    if (refreshRate <= 0 || (int)position.x != windowX || (int)position.y != windowY) {
+        refreshRate = GetMonitorRefreshRate(GetCurrentMonitor());
+        if (refreshRate <= 0)
+            refreshRate = 60;
+        windowX = (int)position.x;
+        windowY = (int)position.y;
+    }
+    return refreshRate;
+}
+
+float FramePacer::predictWorkTime() const {
+    float slowest = 0;
+    for (int i = 1; i <= std::min(historyCount, WorkWindow); ++i)
+        slowest = std::max(slowest, workTimes[(historyNext - i + historyLength) % historyLength]);
+    return slowest + WorkMargin;
+}
+
+void FramePacer::updateStats() {
+    float total = 0;
+    float worst = 0;
+    for (int i = 0; i < historyCount; ++i) {
+        total += frameTimes[i];
+        worst = std::max(worst, frameTimes[i]);
+    }
+    float average = total / historyCount;
+
+    float variance = 0;
+    for (int i = 0; i < historyCount; ++i)
+        variance += (frameTimes[i] - average) * (frameTimes[i] - average);
+    variance /= historyCount;
+
+    stats.averageFrameTime = average * 1000;
+    stats.frameTimeDeviation = sqrtf(variance) * 1000;
+    stats.worstFrameTime = worst * 1000;
+    stats.predictedWorkTime = predictWorkTime() * 1000;
+}
+
+const FramePacerStats& FramePacer::getStats() const {
+    return stats;
+}
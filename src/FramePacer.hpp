@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+
+enum class PacingMode {
+    // The driver paces frames to the display. No cap of our own.
+    VSYNC,
+    // Vsync off, frames start at a fixed rate.
+    CAPPED,
+    // Vsync off, capped, and each frame starts as late as it can while still finishing on time,
+    // so input is read as close to the frame being shown as possible.
+    LOW_LATENCY
+};
+
+struct FramePacerStats {
+    // Over the last second or so of frames, in milliseconds
+    float averageFrameTime = 0;
+    float frameTimeDeviation = 0;
+    float worstFrameTime = 0;
+
+    // Time from the end of the wait to the end of the frame that the next frame plans for.
+    float predictedWorkTime = 0;
+
+    // Frames that finished after their deadline, since the mode or cap last changed.
+    int missedDeadlines = 0;
+};
+
+// Decides when each frame starts. Waits sleep for most of the time and spin for the last bit,
+// since sleeps can overshoot by a millisecond or more. While the window is unfocused or minimized
+// frames are capped at the background rate whatever the mode, so nobody pays for frames that
+// aren't being looked at. On the web the browser paces frames, so this only keeps stats.
+class FramePacer {
+    public:
+        typedef void (*WaitCallback)(void* data);
+
+        FramePacer(PacingMode mode, float targetFps);
+
+        // Vsync is switched to suit the mode, so this needs a window.
+        void setMode(PacingMode mode);
+        PacingMode getMode() const;
+
+        // Zero leaves the frame rate uncapped, apart from vsync.
+        void setTargetFps(float fps);
+        float getTargetFps() const;
+
+        void setBackgroundFps(float fps);
+
+        // Called about every millisecond while beginFrame() waits, for example to keep reading
+        // input. Waits that have a callback sleep in short steps so it keeps getting called.
+        void setWaitCallback(WaitCallback callback, void* data);
+
+        // Waits until the next frame should start. Call at the very top of the frame loop, before
+        // input is read.
+        void beginFrame();
+
+        // Call right after EndDrawing().
+        void endFrame();
+
+        const FramePacerStats& getStats() const;
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        static const int historyLength = 64;
+
+        PacingMode mode;
+        float targetFps;
+        float backgroundFps = 10;
+
+        Clock::time_point frameStart;
+        Clock::time_point deadline;
+        bool started = false;
+        // A frame started without one before it has no frame time, so its work time stands in.
+        bool frameTimeFromWork = false;
+
+        // Looking up the monitor every frame isn't free, so its refresh rate is only looked up
+        // again when the window moves or the mode changes.
+        int refreshRate = 0;
+        int windowX = 0;
+        int windowY = 0;
+
+        // Frame times and work times of recent frames in seconds.
+        float frameTimes[historyLength];
+        float workTimes[historyLength];
+        int historyCount = 0;
+        int historyNext = 0;
+
+        // How much sleeps have overshot lately. Waits spin for this long at the end.
+        float spinTime = 0.002f;
+
+        WaitCallback waitCallback = nullptr;
+        void* waitCallbackData = nullptr;
+
+        FramePacerStats stats;
+
+        void waitUntil(Clock::time_point time);
+        float predictWorkTime() const;
+        int getRefreshRate();
+        void updateStats();
+};
@@ -1,6 +1,7 @@
 #include "GameCamera.hpp"
 
 #include "../libs/raylib/src/raymath.h"
+#include "../libs/raylib/src/rlgl.h"
 
 #include "Ship.hpp"
 #include "MathUtils.hpp"
@@ -19,12 +20,13 @@ GameCamera::GameCamera(bool isPerspective, float fieldOfView) {
     smoothPosition = Vector3Zero();
     smoothTarget = Vector3Zero();
     smoothUp = Vector3Zero();
+
+    view = camera;
 }
 
 void GameCamera::followShip(const Ship& ship, float deltaTime) {
     Vector3 position = ship.transformPoint({ 0, 1, -1 });
-    Vector3 shipForwards = Vector3Scale(ship.getForward(), 25);
-    Vector3 target = Vector3Add(ship.position, shipForwards);
+    Vector3 target = addScaled(ship.position, ship.getForward(), 25);
     Vector3 up = ship.getUp();
 
     moveTo(position, target, up, deltaTime);
@@ -42,6 +44,8 @@ void GameCamera::moveTo(Vector3 position, Vector3 target, Vector3 up, float delt
     camera.up = smoothDamp(
             camera.up, up,
             5, deltaTime);
+
+    view = camera;
 }
 
 void GameCamera::setPosition(Vector3 position, Vector3 target, Vector3 up)
@@ -53,16 +57,70 @@ void GameCamera::setPosition(Vector3 position, Vector3 target, Vector3 up)
     smoothPosition = position;
     smoothTarget = target;
     smoothUp = up;
+
+    view = camera;
+}
+
+void GameCamera::lateLatch(const Ship& ship) {
+    Quaternion turn = multiplyQuaternions(ship.getViewRotation(), QuaternionInvert(ship.rotation));
+
+    view = camera;
+    view.position = Vector3Add(ship.position,
+            rotateVector(turn, Vector3Subtract(camera.position, ship.position)));
+    view.target = Vector3Add(ship.position,
+            rotateVector(turn, Vector3Subtract(camera.target, ship.position)));
+    view.up = rotateVector(turn, camera.up);
 }
 
 Vector3 GameCamera::getPosition() const {
-    return camera.position;
+    return view.position;
+}
+
+void GameCamera::setViewport(Rectangle viewport, int targetWidth, int targetHeight) {
+    this->viewport = viewport;
+    this->targetWidth = targetWidth;
+    this->targetHeight = targetHeight;
 }
 
 void GameCamera::begin3DDrawing() const {
-    BeginMode3D(camera);
+    if (viewport.width <= 0 || viewport.height <= 0) {
+        BeginMode3D(view);
+        return;
+    }
+
+    // Same as BeginMode3D(), which takes the aspect from the whole render target. GL counts
+    // viewport rows from the bottom.
+    rlDrawRenderBatchActive();
+    rlViewport((int)viewport.x, targetHeight - (int)(viewport.y + viewport.height),
+               (int)viewport.width, (int)viewport.height);
+
+    rlMatrixMode(RL_PROJECTION);
+    rlPushMatrix();
+    rlLoadIdentity();
+
+    double aspect = viewport.width / viewport.height;
+    double top = view.projection == CAMERA_PERSPECTIVE
+        ? RL_CULL_DISTANCE_NEAR * tan(view.fovy * 0.5 * DEG2RAD)
+        : view.fovy / 2.0;
+    double right = top * aspect;
+    if (view.projection == CAMERA_PERSPECTIVE) {
+        rlFrustum(-right, right, -top, top, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+    } else {
+        rlOrtho(-right, right, -top, top, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+    }
+
+    rlMatrixMode(RL_MODELVIEW);
+    rlLoadIdentity();
+    Matrix matView = MatrixLookAt(view.position, view.target, view.up);
+    rlMultMatrixf(MatrixToFloat(matView));
+
+    rlEnableDepthTest();
 }
 
 void GameCamera::end3DDrawing() const {
     EndMode3D();
+
+    // What comes after, like the HUD, covers the whole target again.
+    if (viewport.width > 0 && viewport.height > 0)
+        rlViewport(0, 0, targetWidth, targetHeight);
 }
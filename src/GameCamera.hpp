@@ -18,6 +18,14 @@ class GameCamera {
         // Immediately moves the camera to the given positions with no smoothing.
         void setPosition(Vector3 position, Vector3 target, Vector3 up);
 
+        // Turns the view around the ship by however far the drawn ship is ahead of the simulated
+        // one (see Ship::lateLatch), skipping the smoothing. Lasts until the camera next moves.
+        void lateLatch(const Ship& ship);
+
+        // Draws into `viewport`, part of a `targetWidth` by `targetHeight` render target, with the
+        // projection fitted to its shape. The whole target is used until this is called.
+        void setViewport(Rectangle viewport, int targetWidth, int targetHeight);
+
         // Required to tell raylib that any further 3D calls will be made with this camera.
         // Must be paired with EndDrawing().
         void begin3DDrawing() const;
@@ -29,7 +37,14 @@ class GameCamera {
 
         Camera3D camera;
     private:
+        // What's actually rendered. The camera plus any late latched turn.
+        Camera3D view;
+
         Vector3 smoothPosition;
         Vector3 smoothTarget;
         Vector3 smoothUp;
+
+        Rectangle viewport = { 0, 0, 0, 0 };
+        int targetWidth = 0;
+        int targetHeight = 0;
 };
@@ -6,12 +6,24 @@
 #include "SpaceDust.hpp"
 #include "GameCamera.hpp"
 #include "MathUtils.hpp"
-#include "Bullet.hpp"
-#include "Asteroid.hpp"
-#include "Timer.hpp"
+#include "World.hpp"
+#include "State.hpp"
+#include "UILayer.hpp"
+#include "Skybox.hpp"
+#include "RenderQueue.hpp"
+#include "WorldRenderer.hpp"
+#include "FrameArena.hpp"
+#include "AllocationTracker.hpp"
+#include "InputSampler.hpp"
+#include "FramePacer.hpp"
+#include "Metrics.hpp"
+#include "ParticleSystem.hpp"
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 #define MAX(a, b) ((a)>(b)? (a) : (b))
 #define MIN(a, b) ((a)<(b)? (a) : (b))
@@ -24,6 +36,20 @@
 
 #define GAME_TITLE "Hypersonic"
 
+// Four seconds of rewind at 60 FPS. A slot has to fit the whole world state.
+static const int HistoryLength = 240;
+static const int HistorySlotSize = 16 * 1024;
+
+// Frame rate caps F7 cycles through. Zero is uncapped.
+static const float FrameCaps[] = { 0, 30, 60, 120, 144 };
+static const int FrameCapCount = sizeof(FrameCaps) / sizeof(FrameCaps[0]);
+
+// Room for the biggest fights. The whole pool updates in well under a millisecond.
+static const int MaxParticles = 100000;
+static const Color EngineColor = { 255, 150, 60, 255 };
+static const Color ShipExplosionColor = { 255, 110, 40, 255 };
+static const Color AsteroidExplosionColor = { 170, 160, 150, 255 };
+
 enum class Scene { MAIN_SCENE, GAME_SCENE };
 
 Color textColor = {143, 200, 170, 255};
@@ -34,72 +60,74 @@ int screenHeight = 600;
 int renderWidth = 400;
 int renderHeight = 300;
 
-void drawStandardFPS() {
-    BeginBlendMode(BlendMode::BLEND_ADDITIVE);
-    DrawRectangle(5, 5, 45, 15, {143, 200, 170, 100});
-    DrawText(TextFormat("FPS %d", GetFPS()), 9, 8, 10, textColor);
-    DrawRectangleLinesEx({5, 5, 45, 15}, 0.7, textColor);
-    EndBlendMode();
+void applyInputToShip(Ship& ship, const ShipInput& input) {
+    ship.inputForward = input.forward;
+    ship.inputYawLeft = input.yawLeft;
+    ship.inputPitchDown = input.pitchDown;
+    ship.inputRollRight = input.rollRight;
 }
 
-void applyInputToShip(Ship& ship) {
-    ship.inputForward = 1;
-
-    ship.inputYawLeft = 0;
-    if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT)) ship.inputYawLeft -= 1;
-    if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT)) ship.inputYawLeft += 1;
-
-    ship.inputYawLeft = Clamp(ship.inputYawLeft, -1, 1);
-
-    ship.inputPitchDown = 0;
-    if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)) ship.inputPitchDown += 1;
-    if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN)) ship.inputPitchDown -= 1;
-
-    ship.inputPitchDown = Clamp(ship.inputPitchDown, -1, 1);
-
-    ship.inputRollRight = 0;
-    if (IsKeyDown(KEY_Q)) ship.inputRollRight -= 1;
-    if (IsKeyDown(KEY_E)) ship.inputRollRight += 1;
+// Keeps reading input while the pacer waits for the next frame, so a press is timestamped
+// within a millisecond of when it arrives instead of at the start of the next frame.
+void sampleInputWhileWaiting(void* data) {
+    ((InputSampler*)data)->sample();
 }
 
-void printVector3(Vector3 vector) {
-    std::cout << "X: " << vector.x << " Y: " << vector.y << " Z: " << vector.z << std::endl;
+void emitExplosion(ParticleSystem& particles, const Explosion& explosion) {
+    if (explosion.type == ExplosionType::SHIP) {
+        particles.emitBurst(explosion.position, explosion.velocity, 800, 14, 1.2f, ShipExplosionColor);
+    } else {
+        // Bigger asteroids throw out more debris, and further.
+        float radius = explosion.radius;
+        particles.emitBurst(explosion.position, explosion.velocity, (int)(300 * radius), 4 + 4 * radius, 1.5f,
+                            AsteroidExplosionColor);
+    }
 }
 
-void summonEnemy(Ship &player, Model model, std::vector<Ship> &enemies) {
-    Ship other(player);
-    Vector3 random;
-    random.x = GetRandomValue(-10, 10);
-    random.y = GetRandomValue(-10, 10);
-    random.z = GetRandomValue(-10, 10);
-    Vector3 direction = Vector3Normalize(random);
-    other.position = Vector3Add(player.position, Vector3Scale(direction, 15));
-    other.trailColor = MAROON;
-    other.isEnemy = true;
-    enemies.push_back(other);
+void emitEngineParticles(ParticleSystem& particles, const Ship& ship, float deltaTime) {
+    float throttle = Clamp(ship.inputForward, 0, 1);
+    Vector3 nozzle = ship.transformPoint({ 0, 0, -ship.length * 0.5f });
+    Vector3 exhaust = addScaled(ship.velocity, ship.getBack(), 4 + 8 * throttle);
+    particles.emitStream(nozzle, exhaust, 60 + 400 * throttle, 1.5f, 0.35f, EngineColor, deltaTime);
 }
 
-void summonAsteroid(Ship &player, std::vector<Asteroid> &asteroids, Model model) {
-    Vector3 position = Vector3Add(player.position, Vector3Scale(player.getForward(), 40));
-    Vector3 velocity = Vector3Scale(player.getForward(), 20);
-    asteroids.push_back(Asteroid(model, position, velocity));
+// Views past the first follow enemy ships, until there are more local players to follow.
+const Ship& getViewShip(const World& world, int view) {
+    if (view > 0 && view <= (int)world.enemies.size())
+        return world.enemies[view - 1];
+    return world.player;
 }
 
-bool visibleOnScreen(Vector3 position, Camera camera) {
-    Vector2 positionOnScreen = GetWorldToScreenEx(position,
-                                                  camera,
-                                                  renderWidth,
-                                                  renderHeight);
-
-    Rectangle screenRect;
-    screenRect.width = renderWidth;
-    screenRect.height = renderHeight;
-
-    return CheckCollisionPointRec(positionOnScreen, screenRect);
-
+void printVector3(Vector3 vector) {
+    std::cout << "X: " << vector.x << " Y: " << vector.y << " Z: " << vector.z << std::endl;
 }
 
-int main() {
+// Usage: Hypersonic [--metrics path] [--metrics-format prometheus|json] [--metrics-interval 10]
+//                   [--views 1]
+int main(int argc, char** argv) {
+    const char* metricsPath = nullptr;
+    int viewCount = 1;
+    MetricsFormat metricsFormat = MetricsFormat::PROMETHEUS;
+    float metricsInterval = 10;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            metricsPath = argv[++i];
+        } else if (strcmp(argv[i], "--metrics-format") == 0 && i + 1 < argc
+                   && parseMetricsFormat(argv[i + 1], metricsFormat)) {
+            ++i;
+        } else if (strcmp(argv[i], "--metrics-interval") == 0 && i + 1 < argc
+                   && parseMetricsInterval(argv[i + 1], metricsInterval)) {
+            ++i;
+        } else if (strcmp(argv[i], "--views") == 0 && i + 1 < argc) {
+            viewCount = std::min(std::max(atoi(argv[++i]), 1), MaxViews);
+        } else {
+            printf("Usage: %s [--metrics path] [--metrics-format prometheus|json] [--metrics-interval 10]\n"
+                   "       [--views 1]\n", argv[0]);
+            return 1;
+        }
+    }
+
     SetConfigFlags(ConfigFlags::FLAG_MSAA_4X_HINT | ConfigFlags::FLAG_VSYNC_HINT | ConfigFlags::FLAG_WINDOW_RESIZABLE);
     InitWindow(screenWidth, screenHeight, GAME_TITLE);
     SetExitKey(0);
@@ -115,224 +143,376 @@ int main() {
     Camera2D screenSpaceCamera = { 0 };
     screenSpaceCamera.zoom = 1.0f;
 
-    // Load skybox model
-    Mesh cube = GenMeshCube(10.0f, 10.0f, 10.0f);
-    Model skybox = LoadModelFromMesh(cube);
-
-    // Background Image
-    Texture2D backgroundTexture = LoadTexture("assets/background.png");
+    // Background image baked into a cubemap
+    Skybox skybox("assets/background.png", GLSL_VERSION);
 
-    SetMaterialTexture(&skybox.materials[0], MATERIAL_MAP_DIFFUSE, backgroundTexture);
-
-    // Camera
-    GameCamera cameraFlight = GameCamera(true, 50);
+    // A camera for each split screen view. The first one follows the player.
+    std::vector<GameCamera> cameras(viewCount, GameCamera(true, 50));
+    GameCamera& cameraFlight = cameras[0];
+    if (viewCount > 1) {
+        for (int i = 0; i < viewCount; ++i)
+            cameras[i].setViewport(getSplitViewport(i, viewCount, renderWidth, renderHeight), renderWidth, renderHeight);
+    }
 
     Crosshair crosshairFar = Crosshair("assets/crosshairNew.gltf");
     Crosshair crosshairNear = Crosshair("assets/crosshairNew.gltf");
 
-    std::vector<Bullet> bullets;
-    std::vector<Ship> enemies;
-    std::vector<Asteroid> asteroids;
-
     Model shipModel = LoadModel("assets/ship.gltf");
     Model asteroidModel = LoadModel("assets/asteroid.gltf");
 
-    Ship player(shipModel, false);
-    summonEnemy(player, shipModel, enemies);
+    // Every asteroid shares the mesh. The shader gives each one its own shape.
+    Shader asteroidShader = LoadShader(TextFormat("assets/shaders/glsl%i/asteroid.vs", GLSL_VERSION),
+                                       TextFormat("assets/shaders/glsl%i/asteroid.fs", GLSL_VERSION));
+    Asteroid::setShapeShader(asteroidModel, asteroidShader);
+
+    World world(shipModel, asteroidModel, (uint64_t)GetRandomValue(1, 1 << 30));
+    Ship& player = world.player;
+    world.summonEnemy();
     SpaceDust dust = SpaceDust(25, 255);
 
-    Timer asteroidTimer = Timer(2, true);
-    Timer enemyTimer = Timer(5, true);
+    ParticleSystem particles(MaxParticles);
+    particles.loadRenderer(GLSL_VERSION);
+
+    // Recent world states for rewinding, and the state the current run started from for retrying.
+    StateHistory history(HistoryLength, HistorySlotSize);
+    history.save(world.tick, world);
+    StateHistory retryState(1, HistorySlotSize);
+    uint32_t retryTick = 0;
+    double saveMicroseconds = 0;
+    double loadMicroseconds = 0;
 
     Scene currentScene = Scene::MAIN_SCENE;
     bool gamePaused = false;
 
+    // Transient per-frame data is allocated here and freed all at once at the end of the frame.
+    FrameArena frameArena(256 * 1024);
+    RenderQueue renderQueue(getMaxRenderItems(world));
+    bool showDebugOverlay = false;
+    AllocationStats frameAllocations;
+
+    // HUD widgets are laid out once here and only re-rendered when their content changes.
+    UILayer ui(renderWidth, renderHeight);
+
+    int fpsLabel = ui.addLabel("", { 9, 8 }, { 0, 0 }, 10, textColor);
+    ui.setPanel(fpsLabel, { 5, 5, 45, 15 }, { 143, 200, 170, 100 }, textColor, 0.7);
+    ui.setAdditive(fpsLabel, true);
+
+    int titleLabel = ui.addLabel(GAME_TITLE, { renderWidth/2.0f, 100 }, { 0.5, 0 }, 30, textColor);
+    int pressSpaceLabel = ui.addLabel("[Press Space]", { renderWidth/2.0f, 150 }, { 0.5, 0 }, 10, textColor);
+
+    int pauseLabel = ui.addLabel("Game Paused", { renderWidth/2.0f, renderHeight/2.0f }, { 0.5, 0.5 }, 30, RED);
+    ui.setPanel(pauseLabel,
+                { -1, renderHeight/2.0f - 40, renderWidth + 2.0f, 80 },
+                { RED.r, RED.g, RED.b, 100 },
+                RED, 1);
+
+    int debugLabel = ui.addLabel("", { 5, 24 }, { 0, 0 }, 10, textColor);
+    ui.setAdditive(debugLabel, true);
+
+    int stateLabel = ui.addLabel("", { 5, 36 }, { 0, 0 }, 10, textColor);
+    ui.setAdditive(stateLabel, true);
+
+    int memoryLabel = ui.addLabel("", { 5, 48 }, { 0, 0 }, 10, textColor);
+    ui.setAdditive(memoryLabel, true);
+
+    int latencyLabel = ui.addLabel("", { 5, 60 }, { 0, 0 }, 10, textColor);
+    ui.setAdditive(latencyLabel, true);
+
+    int pacingLabel = ui.addLabel("", { 5, 72 }, { 0, 0 }, 10, textColor);
+    ui.setAdditive(pacingLabel, true);
+
+    int renderTimeLabel = ui.addLabel("", { 5, 84 }, { 0, 0 }, 10, textColor);
+    ui.setAdditive(renderTimeLabel, true);
+
+    // Input is sampled again right before rendering so the view can be turned by the newest
+    // input. F5 switches that off to compare, F4 shows the measured latency.
+    InputSampler input;
+    const int watchedKeys[] = { KEY_SPACE, KEY_ESCAPE, KEY_R, KEY_I, KEY_O, KEY_F3, KEY_F4, KEY_F5, KEY_F6, KEY_F7 };
+    for (int key : watchedKeys)
+        input.watchKey(key);
+    bool lateLatch = true;
+    bool showTiming = false;
+
+    // Starts out paced by vsync like before. F6 cycles the pacing mode and F7 the cap.
+    FramePacer pacer(PacingMode::VSYNC, 0);
+    pacer.setWaitCallback(sampleInputWhileWaiting, &input);
+    int frameCapIndex = 0;
+
+    // Only written out when asked for with --metrics.
+    Metrics metrics(HYPERSONIC_BUILD);
+    int framesMetric = metrics.addCounter("frames_total", "Frames rendered.");
+    int frameTimeMetric = metrics.addHistogram("frame_seconds", "Time between frames.",
+                                               { 0.004, 0.0083, 0.0167, 0.025, 0.0333, 0.05, 0.1 });
+    int tickTimeMetric = metrics.addHistogram("tick_seconds", "Time a world update takes.",
+                                              { 0.00025, 0.0005, 0.001, 0.002, 0.004, 0.008 });
+    int bulletsMetric = metrics.addGauge("bullets", "Live bullets.");
+    int enemiesMetric = metrics.addGauge("enemies", "Live enemy ships.");
+    int asteroidsMetric = metrics.addGauge("asteroids", "Live asteroids outside the field.");
+    int chunksMetric = metrics.addGauge("field_chunks", "Asteroid field chunks loaded.");
+    int collisionsMetric = metrics.addCounter("collision_tests_total", "Collision pairs tested.");
+    int drawCallsMetric = metrics.addGauge("draw_calls", "Draw calls in the last frame.");
+    int droppedItemsMetric = metrics.addCounter("render_dropped_items_total", "Draws dropped because the render queue was full.");
+    int particlesMetric = metrics.addGauge("particles", "Live particles.");
+    int sharedRenderMetric = metrics.addHistogram("render_shared_seconds", "Time the work all views share takes.",
+                                                  { 0.0001, 0.00025, 0.0005, 0.001, 0.002, 0.004 });
+    int viewRenderMetric = metrics.addHistogram("render_view_seconds", "Time a view's cull, submission and draws take.",
+                                                { 0.0001, 0.00025, 0.0005, 0.001, 0.002, 0.004 });
+    int memoryMetric = metrics.addGauge("resident_memory_bytes", "Physical memory in use.");
+    float memoryTimer = 0;
+
+    // CPU time of the last frame's rendering, in milliseconds. Each extra view should cost far
+    // less than the whole.
+    double sharedRenderTime = 0;
+    double viewRenderTimes[MaxViews] = {};
+    RenderQueue::Stats renderStats;
+
+    if (metricsPath && !metrics.openFile(metricsPath, metricsFormat, metricsInterval)) {
+        printf("Couldn't open %s for metrics\n", metricsPath);
+    }
+
     while (!WindowShouldClose()) {
+        pacer.beginFrame();
         auto deltaTime = GetFrameTime();
-
-        { // Timers
-            if (asteroidTimer.update(deltaTime)) {
-                summonAsteroid(player, asteroids, asteroidModel);
-            }
-
-            if (enemyTimer.update(deltaTime) && enemies.size() < 4) {
-                summonEnemy(player, shipModel, enemies);
-            }
-        }
+        bool rewinding = false;
+        AllocationStats frameStart = getAllocationStats();
+        double simulatedAt = GetTime();
 
         { // Capture input
+            input.sample();
+
             if (!gamePaused) {
-                applyInputToShip(player);
+                applyInputToShip(player, input.getShipInput());
 
-                for (auto &enemy : enemies) {
-                    applyInputToShip(enemy);
+                for (auto &enemy : world.enemies) {
+                    applyInputToShip(enemy, input.getShipInput());
                 }
+                input.markApplied();
             }
 
             if (currentScene == Scene::MAIN_SCENE) {
-                if (IsKeyPressed(KEY_SPACE)) {
+                if (input.wasPressed(KEY_SPACE)) {
                     currentScene = Scene::GAME_SCENE;
+                    retryTick = world.tick;
+                    retryState.save(retryTick, world);
                 }
             }
 
             if (currentScene == Scene::GAME_SCENE) {
-                if (IsKeyPressed(KEY_ESCAPE)) {
+                if (input.wasPressed(KEY_ESCAPE)) {
                     gamePaused = !gamePaused;
                 }
+
+                if (input.wasPressed(KEY_R)) {
+                    retryState.restore(retryTick, world);
+                }
+
+                rewinding = IsKeyDown(KEY_BACKSPACE);
+            }
+
+            if (input.wasPressed(KEY_SPACE)) {
+                world.fireBullet();
+            }
+
+            if (input.wasPressed(KEY_I)) {
+                world.summonEnemy();
+            }
+
+            if (input.wasPressed(KEY_O)) {
+                world.summonAsteroid();
+            }
+
+            if (input.wasPressed(KEY_F3)) {
+                showDebugOverlay = !showDebugOverlay;
             }
 
-            if (IsKeyPressed(KEY_SPACE)) {
-                bullets.push_back(Bullet(false,
-                            RED,
-                            player.position,
-                            Vector3Scale(player.getForward(),
-                                100)));
+            if (input.wasPressed(KEY_F4)) {
+                showTiming = !showTiming;
             }
 
-            if (IsKeyPressed(KEY_I)) {
-                summonEnemy(player, shipModel, enemies);
+            if (input.wasPressed(KEY_F5)) {
+                lateLatch = !lateLatch;
             }
 
-            if (IsKeyPressed(KEY_O)) {
-                summonAsteroid(player, asteroids, asteroidModel);
+            if (input.wasPressed(KEY_F6)) {
+                pacer.setMode((PacingMode)(((int)pacer.getMode() + 1) % 3));
             }
+
+            if (input.wasPressed(KEY_F7)) {
+                frameCapIndex = (frameCapIndex + 1) % FrameCapCount;
+                pacer.setTargetFps(FrameCaps[frameCapIndex]);
+            }
+
+            input.endFrame();
         }
 
         { // Gameplay updates
             if (!gamePaused) {
-                player.update(deltaTime);
-
-                // Remove dead bullets
-                bullets.erase(std::remove_if(bullets.begin(),
-                            bullets.end(),
-                            [&](Bullet& bullet) {
-                            return bullet.isDead;
-                            }),
-                        bullets.end());
-
-                // Remove dead enemies
-                enemies.erase(std::remove_if(enemies.begin(),
-                              enemies.end(),
-                              [&](Ship& enemy) {
-                                return enemy.isDead;
-                              }),
-                        enemies.end());
-
-                // Remove dead asteroids
-                asteroids.erase(std::remove_if(asteroids.begin(),
-                                asteroids.end(),
-                                [&](Asteroid& asteroid) {
-                                    return asteroid.isDead;
-                                }),
-                                asteroids.end());
-
-                // Update bullets
-                for (auto &bullet : bullets) {
-                    bullet.update(deltaTime);
-
-                    for (auto &enemy : enemies) {
-                        if (Vector3Distance(enemy.position, bullet.position) < 0.5) {
-                            bullet.isDead = true;
-                            enemy.isDead = true;
-                        }
+                if (rewinding) {
+                    // Step back through the saved ticks, one per frame.
+                    if (history.contains(world.tick - 1)) {
+                        double start = GetTime();
+                        history.restore(world.tick - 1, world);
+                        loadMicroseconds = (GetTime() - start) * 1000000;
                     }
-
-                    for (auto &asteroid : asteroids) {
-                        if (Vector3Distance(asteroid.position, bullet.position) < 1) {
-                            bullet.isDead = true;
-                            asteroid.isDead = true;
+                } else {
+                    double tickStart = GetTime();
+                    world.update(deltaTime);
+                    metrics.observe(tickTimeMetric, GetTime() - tickStart);
+                    metrics.increment(collisionsMetric, world.collisionTests);
+
+                    // Crashing restarts the run. There's nothing to restart on the title screen.
+                    if (player.isDead) {
+                        if (currentScene == Scene::GAME_SCENE) {
+                            retryState.restore(retryTick, world);
+                        } else {
+                            player.isDead = false;
                         }
                     }
-                }
 
-                // Update asteroids
-                for (auto &asteroid : asteroids) {
-                    asteroid.update(deltaTime);
+                    double start = GetTime();
+                    history.save(world.tick, world);
+                    saveMicroseconds = (GetTime() - start) * 1000000;
 
-                    if (Vector3Distance(asteroid.position, player.position) > 50) {
-                        asteroid.isDead = true;
+                    for (auto &explosion : world.explosions) {
+                        emitExplosion(particles, explosion);
                     }
-                }
 
-                // Update enemy
-                for (auto &enemy : enemies) {
-                    enemy.update(deltaTime);
+                    emitEngineParticles(particles, player, deltaTime);
+                    for (auto &enemy : world.enemies) {
+                        emitEngineParticles(particles, enemy, deltaTime);
+                    }
                 }
 
+                // Particles keep going while rewinding, they aren't part of the world state.
+                particles.update(deltaTime);
+                particles.upload();
+
                 // Position crosshair
                 crosshairFar.positionCrosshairOnShip(player, 40);
                 crosshairNear.positionCrosshairOnShip(player, 20);
 
-                // Camera movement and visual effects
-                cameraFlight.followShip(player, deltaTime);
-                dust.updateViewPosition(cameraFlight.getPosition());
+                // Camera movement
+                for (int i = 0; i < viewCount; ++i) {
+                    cameras[i].followShip(getViewShip(world, i), deltaTime);
+                }
             }
         }
 
-        { // Render in texture
-            BeginTextureMode(renderTarget);
-            ClearBackground(BLACK);
-
-            {// Start Drawing in 3D
-                cameraFlight.begin3DDrawing();
-
-                {// Draw space background
-                    rlDisableBackfaceCulling();
-                    rlDisableDepthMask();
-                    DrawModel(skybox, cameraFlight.getPosition(), 5.0f, WHITE);
-                    rlEnableBackfaceCulling();
-                    rlEnableDepthMask();
+        { // Update HUD
+            ui.setValue(fpsLabel, "FPS %d", GetFPS());
+            ui.setVisible(titleLabel, currentScene == Scene::MAIN_SCENE);
+            ui.setVisible(pressSpaceLabel, currentScene == Scene::MAIN_SCENE);
+            ui.setVisible(pauseLabel, gamePaused);
+
+            ui.setVisible(debugLabel, showDebugOverlay);
+            ui.setVisible(stateLabel, showDebugOverlay);
+            ui.setVisible(memoryLabel, showDebugOverlay);
+            ui.setVisible(latencyLabel, showTiming);
+            ui.setVisible(pacingLabel, showTiming);
+            ui.setVisible(renderTimeLabel, showTiming);
+            if (showDebugOverlay) {
+                char text[64];
+                snprintf(text, sizeof(text), "draws %d  states %d  flushes %d  dropped %d",
+                         renderStats.drawCalls, renderStats.stateChanges, renderStats.batchFlushes,
+                         renderStats.droppedItems);
+                ui.setText(debugLabel, text);
+
+                snprintf(text, sizeof(text), "state %d B  save %.1f us  load %.1f us",
+                         history.getSize(world.tick), saveMicroseconds, loadMicroseconds);
+                ui.setText(stateLabel, text);
+
+                // Allocations are from the previous frame, since this frame isn't over yet.
+                if (isAllocationTrackingEnabled()) {
+                    snprintf(text, sizeof(text), "allocs %d (%d B)  arena %d/%d KB",
+                             (int)frameAllocations.count, (int)frameAllocations.bytes,
+                             (int)(frameArena.getPeak() / 1024), (int)(frameArena.getCapacity() / 1024));
+                } else {
+                    snprintf(text, sizeof(text), "allocs untracked  arena %d/%d KB",
+                             (int)(frameArena.getPeak() / 1024), (int)(frameArena.getCapacity() / 1024));
                 }
+                ui.setText(memoryLabel, text);
+            }
+            if (showTiming) {
+                char text[96];
+                snprintf(text, sizeof(text), "input %.1f ms  avg %.1f  max %.1f  %dx/frame  late latch %s",
+                         input.getLastLatency(), input.getAverageLatency(), input.getMaxLatency(),
+                         input.getSamplesPerFrame(), lateLatch ? "on" : "off");
+                ui.setText(latencyLabel, text);
+
+                static const char* modeNames[] = { "vsync", "capped", "low latency" };
+                auto& pacing = pacer.getStats();
+                snprintf(text, sizeof(text), "%s %d fps  frame %.2f ms  sd %.2f  worst %.2f  missed %d",
+                         modeNames[(int)pacer.getMode()], (int)pacer.getTargetFps(),
+                         pacing.averageFrameTime, pacing.frameTimeDeviation, pacing.worstFrameTime,
+                         pacing.missedDeadlines);
+                ui.setText(pacingLabel, text);
+
+                int length = snprintf(text, sizeof(text), "render shared %.2f ms  views", sharedRenderTime);
+                for (int i = 0; i < viewCount; ++i)
+                    length += snprintf(text + length, sizeof(text) - length, " %.2f", viewRenderTimes[i]);
+                ui.setText(renderTimeLabel, text);
+            }
+            ui.refresh();
+        }
 
-                player.draw(false);
+        { // Submit draws
+            // Work every view shares is done once, then each view culls, submits and draws into
+            // its part of the render target.
+            double sharedStart = GetTime();
+            WorldView views[MaxViews];
+            for (int i = 0; i < viewCount; ++i) {
+                Rectangle viewport = getSplitViewport(i, viewCount, renderWidth, renderHeight);
+                views[i].camera = &cameras[i];
+                views[i].ship = &getViewShip(world, i);
+                views[i].skybox = &skybox;
+                views[i].dust = &dust;
+                views[i].particles = &particles;
+                views[i].width = (int)viewport.width;
+                views[i].height = (int)viewport.height;
+            }
+            views[0].crosshairFar = &crosshairFar;
+            views[0].crosshairNear = &crosshairNear;
 
-                // Draw bullets
-                for (auto &bullet : bullets) {
-                    bullet.draw();
-                }
+            // The HUD covers the whole target, so it's drawn once, after the last view.
+            views[viewCount - 1].ui = &ui;
 
-                // Draw asteroids
-                for (auto &asteroid : asteroids) {
-                    asteroid.draw();
-                }
+            SharedWorld shared = prepareWorld(frameArena, world, views, viewCount);
+            sharedRenderTime = (GetTime() - sharedStart) * 1000;
+            metrics.observe(sharedRenderMetric, sharedRenderTime / 1000);
 
-                // Draw enemies and arrows
-                for (auto &enemy : enemies) {
-                    enemy.draw(false);
+            renderStats = RenderQueue::Stats();
+            BeginTextureMode(renderTarget);
+            ClearBackground(BLACK);
 
-                    if (!visibleOnScreen(enemy.position, cameraFlight.camera)) {
-                        Vector3 pointer = Vector3Subtract(player.position, enemy.position);
-                        pointer = Vector3Normalize(pointer);
-                        Vector3 startPosition = Vector3Add(player.position, Vector3Scale(pointer, -0.5));
-                        Vector3 endPosition = Vector3Add(player.position, Vector3Scale(pointer, -0.7));
-                        DrawCylinderWiresEx(startPosition, endPosition, 0.07, 0, 10, RED);
-                    }
+            for (int i = 0; i < viewCount; ++i) {
+                double viewStart = GetTime();
+                renderQueue.begin(cameras[i].getPosition(), frameArena);
+                submitWorld(renderQueue, frameArena, world, shared, views[i]);
+
+                // Late latch: turn the player and the view by whatever input came in since the
+                // simulation ran. Draw callbacks read the ship's transform, so this still applies
+                // to everything submitted above, and to every view drawn after.
+                if (i == 0 && lateLatch && !gamePaused && !rewinding) {
+                    input.sample();
+                    player.lateLatch(input.getShipInput(), (float)(GetTime() - simulatedAt));
+                    cameraFlight.lateLatch(player);
+                    crosshairFar.positionCrosshairOnShip(player, 40);
+                    crosshairNear.positionCrosshairOnShip(player, 20);
+                    input.markApplied();
                 }
 
-                crosshairFar.drawCrosshair();
-                crosshairNear.drawCrosshair();
+                renderQueue.execute(cameras[i]);
 
-                dust.draw(cameraFlight.getPosition(), player.velocity, false);
-                cameraFlight.end3DDrawing();
-            }
+                auto& stats = renderQueue.getStats();
+                renderStats.drawCalls += stats.drawCalls;
+                renderStats.stateChanges += stats.stateChanges;
+                renderStats.batchFlushes += stats.batchFlushes;
+                renderStats.droppedItems += stats.droppedItems;
 
-            { // UI Code here
-                drawStandardFPS();
-                if (currentScene == Scene::MAIN_SCENE) {
-                    DrawText(GAME_TITLE, renderWidth/2 - (MeasureText(GAME_TITLE, 30)/2), 100, 30, textColor);
-                    DrawText("[Press Space]", renderWidth/2 - (MeasureText("[Press Space]", 10)/2), 150, 10, textColor);
-                }
-
-                // Draw Pause Screen
-                if (gamePaused) {
-                    char text[] = "Game Paused";
-                    int fontSize = 30;
-                    Vector2 measure = MeasureTextEx(GetFontDefault(), text, fontSize, 3);
-                    DrawRectangle(0, (renderHeight/2) - 40, screenWidth, 80, {RED.r, RED.g, RED.b, 100});
-                    DrawRectangleLines(-1, (renderHeight/2) - 40, screenWidth, 80, RED);
-                    DrawText(text, renderWidth/2.0 - (measure.x/2.0), renderHeight/2.0 - (measure.y/2.0), 30, RED);
-                }
+                viewRenderTimes[i] = (GetTime() - viewStart) * 1000;
+                metrics.observe(viewRenderMetric, viewRenderTimes[i] / 1000);
             }
+
             EndTextureMode();
         }
 
@@ -350,12 +530,44 @@ int main() {
                     (float)renderWidth*scale, (float)renderHeight*scale }, { 0, 0 }, 0.0f, WHITE);
             EndMode2D();
             EndDrawing();
+            input.markPresented();
+            pacer.endFrame();
         }
+
+        frameArena.reset();
+
+        if (metrics.isOpen()) {
+            metrics.increment(framesMetric);
+            metrics.observe(frameTimeMetric, deltaTime);
+            metrics.set(bulletsMetric, (double)world.bullets.size());
+            metrics.set(enemiesMetric, (double)world.enemies.size());
+            metrics.set(asteroidsMetric, (double)world.asteroids.size());
+            metrics.set(chunksMetric, world.field.getLoadedChunkCount());
+            metrics.set(drawCallsMetric, renderStats.drawCalls);
+            metrics.increment(droppedItemsMetric, renderStats.droppedItems);
+            metrics.set(particlesMetric, particles.getCount());
+
+            // Reading memory use is a system call, so it's only done once a second.
+            memoryTimer += deltaTime;
+            if (memoryTimer >= 1) {
+                memoryTimer = 0;
+                metrics.set(memoryMetric, (double)getResidentMemory());
+            }
+
+            metrics.update(deltaTime);
+        }
+
+        AllocationStats frameEnd = getAllocationStats();
+        frameAllocations.count = frameEnd.count - frameStart.count;
+        frameAllocations.bytes = frameEnd.bytes - frameStart.bytes;
     }
 
+    metrics.write();
+
     UnloadRenderTexture(renderTarget);
     UnloadModel(shipModel);
     UnloadModel(asteroidModel);
+    UnloadShader(asteroidShader);
     CloseWindow();
     return 0;
 }
@@ -0,0 +1,132 @@
+#include "InputSampler.hpp"
+
+#include "../libs/raylib/src/raymath.h"
+
+#include <algorithm>
+
+static bool sameShipInput(const ShipInput& a, const ShipInput& b) {
+    return a.pitchDown == b.pitchDown && a.rollRight == b.rollRight && a.yawLeft == b.yawLeft;
+}
+
+static ShipInput readShipInput() {
+    ShipInput input;
+    input.forward = 1;
+
+    if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT)) input.yawLeft -= 1;
+    if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT)) input.yawLeft += 1;
+    input.yawLeft = Clamp(input.yawLeft, -1, 1);
+
+    if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)) input.pitchDown += 1;
+    if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN)) input.pitchDown -= 1;
+    input.pitchDown = Clamp(input.pitchDown, -1, 1);
+
+    if (IsKeyDown(KEY_Q)) input.rollRight -= 1;
+    if (IsKeyDown(KEY_E)) input.rollRight += 1;
+
+    return input;
+}
+
+InputSampler::InputSampler() {
+    shipInput = readShipInput();
+}
+
+void InputSampler::watchKey(int key) {
+    if (keyCount == maxWatchedKeys)
+        return;
+
+    keys[keyCount] = key;
+    keyDown[keyCount] = IsKeyDown(key);
+    keyPressed[keyCount] = false;
+    keyCount++;
+}
+
+void InputSampler::sample() {
+    // The first sample of a frame uses the events EndDrawing() just collected. Later ones have to
+    // collect their own. Browsers only deliver events between frames, so on the web there's
+    // nothing new to collect.
+#if defined(PLATFORM_DESKTOP)
+    if (samples > 0)
+        PollInputEvents();
+#endif
+    samples++;
+
+    for (int i = 0; i < keyCount; ++i) {
+        bool down = IsKeyDown(keys[i]);
+        if (down && !keyDown[i])
+            keyPressed[i] = true;
+        keyDown[i] = down;
+    }
+
+    double now = GetTime();
+    ShipInput input = readShipInput();
+    if (!sameShipInput(input, shipInput) && changedAt < 0)
+        changedAt = sampledAt < 0 ? now : (sampledAt + now) / 2;
+    shipInput = input;
+    sampledAt = now;
+}
+
+bool InputSampler::wasPressed(int key) const {
+    for (int i = 0; i < keyCount; ++i) {
+        if (keys[i] == key)
+            return keyPressed[i];
+    }
+    return false;
+}
+
+const ShipInput& InputSampler::getShipInput() const {
+    return shipInput;
+}
+
+void InputSampler::markApplied() {
+    if (changedAt < 0)
+        return;
+
+    if (appliedAt < 0)
+        appliedAt = changedAt;
+    changedAt = -1;
+}
+
+void InputSampler::markPresented() {
+    samplesPerFrame = samples;
+    samples = 0;
+
+    if (appliedAt < 0)
+        return;
+
+    latencies[latencyNext] = (float)((GetTime() - appliedAt) * 1000);
+    latencyNext = (latencyNext + 1) % latencyHistory;
+    latencyCount = std::min(latencyCount + 1, latencyHistory);
+    appliedAt = -1;
+}
+
+void InputSampler::endFrame() {
+    for (int i = 0; i < keyCount; ++i)
+        keyPressed[i] = false;
+}
+
+float InputSampler::getLastLatency() const {
+    if (latencyCount == 0)
+        return 0;
+    return latencies[(latencyNext + latencyHistory - 1) % latencyHistory];
+}
+
+float InputSampler::getAverageLatency() const {
+    if (latencyCount == 0)
+        return 0;
+
+    float total = 0;
+    for (int i = 0; i < latencyCount; ++i)
+        total += latencies[i];
+    return total / latencyCount;
+}
+
+float InputSampler::getMaxLatency() const {
+    float highest = 0;
+    for (int i = 0; i < latencyCount; ++i)
+        highest = std::max(highest, latencies[i]);
+    return highest;
+}
+
+int InputSampler::getSamplesPerFrame() const {
+    return samplesPerFrame;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "../libs/raylib/src/raylib.h"
+
+#include "Ship.hpp"
+
+// Reads the keyboard more than once a frame. Raylib only collects input events once per frame,
+// right after presenting, so something pressed during a frame isn't seen until the next one.
+// Sampling again just before rendering lets the newest input reach the screen a frame sooner.
+//
+// Presses of watched keys are latched until endFrame(), so extra samples never lose one the way
+// they would with IsKeyPressed().
+class InputSampler {
+    public:
+        InputSampler();
+
+        // Makes wasPressed() work for `key`.
+        void watchKey(int key);
+
+        // Collects pending input events and reads the keyboard. Can be called any number of times
+        // a frame, for example while waiting for the next one.
+        void sample();
+
+        // Whether `key` went down in any sample since endFrame().
+        bool wasPressed(int key) const;
+
+        // Flight controls as of the last sample.
+        const ShipInput& getShipInput() const;
+
+        // Latency is measured from when the flight controls changed to when a frame showing the
+        // change has been handed to the driver. Key events only arrive when they're polled, so a
+        // change is taken to have happened halfway between the sample that saw it and the one
+        // before. The more often sample() is called, the closer that is. Call markApplied() once
+        // the latest input has made it into what's about to be rendered, and markPresented()
+        // right after EndDrawing().
+        void markApplied();
+        void markPresented();
+
+        // Clears presses. Call once the frame's key presses have been handled.
+        void endFrame();
+
+        // In milliseconds, over the last few changes.
+        float getLastLatency() const;
+        float getAverageLatency() const;
+        float getMaxLatency() const;
+
+        // Samples taken in the previous frame.
+        int getSamplesPerFrame() const;
+
+    private:
+        static const int maxWatchedKeys = 16;
+        static const int latencyHistory = 32;
+
+        int keys[maxWatchedKeys];
+        bool keyDown[maxWatchedKeys];
+        bool keyPressed[maxWatchedKeys];
+        int keyCount = 0;
+
+        ShipInput shipInput;
+
+        // When changes happened, or negative if there's nothing waiting.
+        double changedAt = -1;
+        double sampledAt = -1;
+        double appliedAt = -1;
+
+        float latencies[latencyHistory];
+        int latencyCount = 0;
+        int latencyNext = 0;
+
+        int samples = 0;
+        int samplesPerFrame = 0;
+};
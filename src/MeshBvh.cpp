@@ -0,0 +1,282 @@
+#include "MeshBvh.hpp"
+
+#include "../libs/raylib/src/raymath.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+static const int MaxLeafTriangles = 4;
+static const int MaxDepth = 64;
+
+static float getAxis(Vector3 v, int axis) {
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+static BoundingBox emptyBounds() {
+    return BoundingBox{ { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+}
+
+static void growBounds(BoundingBox& bounds, Vector3 point) {
+    bounds.min = Vector3Min(bounds.min, point);
+    bounds.max = Vector3Max(bounds.max, point);
+}
+
+// Slab test. Returns the distance the ray enters the box at, or a negative number on a miss.
+static float rayEntersBox(const BoundingBox& box, Vector3 origin, Vector3 inverseDirection, float maxDistance) {
+    float tx1 = (box.min.x - origin.x) * inverseDirection.x;
+    float tx2 = (box.max.x - origin.x) * inverseDirection.x;
+    float ty1 = (box.min.y - origin.y) * inverseDirection.y;
+    float ty2 = (box.max.y - origin.y) * inverseDirection.y;
+    float tz1 = (box.min.z - origin.z) * inverseDirection.z;
+    float tz2 = (box.max.z - origin.z) * inverseDirection.z;
+
+    float enter = std::max(std::max(std::min(tx1, tx2), std::min(ty1, ty2)), std::min(tz1, tz2));
+    float exit = std::min(std::min(std::max(tx1, tx2), std::max(ty1, ty2)), std::max(tz1, tz2));
+
+    if (exit < 0 || enter > exit || enter > maxDistance)
+        return -1;
+    return std::max(enter, 0.0f);
+}
+
+static float boxDistanceSqr(const BoundingBox& box, Vector3 point) {
+    Vector3 clamped = Vector3Min(Vector3Max(point, box.min), box.max);
+    return Vector3DistanceSqr(point, clamped);
+}
+
+// Möller-Trumbore, hitting both sides of the triangle.
+static bool rayHitsTriangle(Vector3 origin, Vector3 direction, Vector3 a, Vector3 b, Vector3 c, float& distance) {
+    Vector3 edge1 = Vector3Subtract(b, a);
+    Vector3 edge2 = Vector3Subtract(c, a);
+    Vector3 p = Vector3CrossProduct(direction, edge2);
+    float determinant = Vector3DotProduct(edge1, p);
+    if (fabsf(determinant) < 1e-8f)
+        return false;
+
+    float inverse = 1 / determinant;
+    Vector3 t = Vector3Subtract(origin, a);
+    float u = Vector3DotProduct(t, p) * inverse;
+    if (u < 0 || u > 1)
+        return false;
+
+    Vector3 q = Vector3CrossProduct(t, edge1);
+    float v = Vector3DotProduct(direction, q) * inverse;
+    if (v < 0 || u + v > 1)
+        return false;
+
+    distance = Vector3DotProduct(edge2, q) * inverse;
+    return distance >= 0;
+}
+
+// From Real-Time Collision Detection (Ericson), 5.1.5.
+static Vector3 closestPointOnTriangle(Vector3 p, Vector3 a, Vector3 b, Vector3 c) {
+    Vector3 ab = Vector3Subtract(b, a);
+    Vector3 ac = Vector3Subtract(c, a);
+    Vector3 ap = Vector3Subtract(p, a);
+    float d1 = Vector3DotProduct(ab, ap);
+    float d2 = Vector3DotProduct(ac, ap);
+    if (d1 <= 0 && d2 <= 0) return a;
+
+    Vector3 bp = Vector3Subtract(p, b);
+    float d3 = Vector3DotProduct(ab, bp);
+    float d4 = Vector3DotProduct(ac, bp);
+    if (d3 >= 0 && d4 <= d3) return b;
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0)
+        return Vector3Add(a, Vector3Scale(ab, d1 / (d1 - d3)));
+
+    Vector3 cp = Vector3Subtract(p, c);
+    float d5 = Vector3DotProduct(ab, cp);
+    float d6 = Vector3DotProduct(ac, cp);
+    if (d6 >= 0 && d5 <= d6) return c;
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0)
+        return Vector3Add(a, Vector3Scale(ac, d2 / (d2 - d6)));
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+        return Vector3Add(b, Vector3Scale(Vector3Subtract(c, b), (d4 - d3) / ((d4 - d3) + (d5 - d6))));
+
+    float denominator = 1 / (va + vb + vc);
+    float v = vb * denominator;
+    float w = vc * denominator;
+    return Vector3Add(a, Vector3Add(Vector3Scale(ab, v), Vector3Scale(ac, w)));
+}
+
+MeshBvh::MeshBvh(const Mesh& mesh) {
+    triangles.reserve(mesh.triangleCount);
+
+    for (int i = 0; i < mesh.triangleCount; ++i) {
+        int index[3];
+        for (int j = 0; j < 3; ++j)
+            index[j] = mesh.indices ? mesh.indices[i * 3 + j] : i * 3 + j;
+
+        Vector3 corners[3];
+        for (int j = 0; j < 3; ++j) {
+            const float* vertex = &mesh.vertices[index[j] * 3];
+            corners[j] = { vertex[0], vertex[1], vertex[2] };
+            boundingRadius = std::max(boundingRadius, Vector3Length(corners[j]));
+        }
+
+        Triangle triangle;
+        triangle.a = corners[0];
+        triangle.b = corners[1];
+        triangle.c = corners[2];
+        triangle.normal = Vector3Normalize(Vector3CrossProduct(Vector3Subtract(triangle.b, triangle.a),
+                                                               Vector3Subtract(triangle.c, triangle.a)));
+        triangles.push_back(triangle);
+    }
+
+    // A binary tree with single triangle leaves would have 2n - 1 nodes, so this never grows.
+    nodes.reserve(std::max(1, (int)triangles.size() * 2));
+    build(0, (int)triangles.size());
+}
+
+int MeshBvh::build(int first, int count) {
+    int index = (int)nodes.size();
+    nodes.push_back(Node());
+
+    BoundingBox bounds = emptyBounds();
+    BoundingBox centroidBounds = emptyBounds();
+    for (int i = first; i < first + count; ++i) {
+        const Triangle& triangle = triangles[i];
+        growBounds(bounds, triangle.a);
+        growBounds(bounds, triangle.b);
+        growBounds(bounds, triangle.c);
+        growBounds(centroidBounds, Vector3Scale(Vector3Add(triangle.a, Vector3Add(triangle.b, triangle.c)), 1 / 3.0f));
+    }
+    nodes[index].bounds = bounds;
+
+    if (count <= MaxLeafTriangles) {
+        nodes[index].first = first;
+        nodes[index].count = count;
+        return index;
+    }
+
+    // Split at the median centroid along the longest axis.
+    Vector3 extent = Vector3Subtract(centroidBounds.max, centroidBounds.min);
+    int axis = 0;
+    if (extent.y > extent.x) axis = 1;
+    if (extent.z > getAxis(extent, axis)) axis = 2;
+
+    int half = count / 2;
+    std::nth_element(triangles.begin() + first, triangles.begin() + first + half, triangles.begin() + first + count,
+                     [axis](const Triangle& a, const Triangle& b) {
+                         return getAxis(a.a, axis) + getAxis(a.b, axis) + getAxis(a.c, axis)
+                              < getAxis(b.a, axis) + getAxis(b.b, axis) + getAxis(b.c, axis);
+                     });
+
+    build(first, half);
+    int right = build(first + half, count - half);
+    nodes[index].first = right;
+    nodes[index].count = 0;
+    return index;
+}
+
+bool MeshBvh::raycast(Vector3 origin, Vector3 direction, float maxDistance, float& hitDistance) const {
+    float nearest = maxDistance;
+    if (traceRay(origin, direction, true, nearest) == 0)
+        return false;
+
+    hitDistance = nearest;
+    return true;
+}
+
+int MeshBvh::traceRay(Vector3 origin, Vector3 direction, bool nearestOnly, float& maxDistance) const {
+    if (nodes.empty())
+        return 0;
+
+    Vector3 inverseDirection = { 1 / direction.x, 1 / direction.y, 1 / direction.z };
+    int hits = 0;
+
+    int stack[MaxDepth];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Node& node = nodes[stack[--stackSize]];
+        if (rayEntersBox(node.bounds, origin, inverseDirection, maxDistance) < 0)
+            continue;
+
+        if (node.count > 0) {
+            for (int i = node.first; i < node.first + node.count; ++i) {
+                const Triangle& triangle = triangles[i];
+                float distance;
+                if (rayHitsTriangle(origin, direction, triangle.a, triangle.b, triangle.c, distance)
+                    && distance <= maxDistance) {
+                    hits++;
+                    if (nearestOnly)
+                        maxDistance = distance;
+                }
+            }
+        } else if (stackSize + 2 <= MaxDepth) {
+            stack[stackSize++] = node.first;
+            stack[stackSize++] = (int)(&node - &nodes[0]) + 1;
+        }
+    }
+
+    return hits;
+}
+
+bool MeshBvh::closestPoint(Vector3 point, float maxDistance, Vector3& closest, Vector3& normal) const {
+    if (nodes.empty())
+        return false;
+
+    float nearestSqr = maxDistance * maxDistance;
+    bool found = false;
+
+    int stack[MaxDepth];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Node& node = nodes[stack[--stackSize]];
+        if (boxDistanceSqr(node.bounds, point) > nearestSqr)
+            continue;
+
+        if (node.count > 0) {
+            for (int i = node.first; i < node.first + node.count; ++i) {
+                const Triangle& triangle = triangles[i];
+                Vector3 candidate = closestPointOnTriangle(point, triangle.a, triangle.b, triangle.c);
+                float distanceSqr = Vector3DistanceSqr(point, candidate);
+                if (distanceSqr <= nearestSqr) {
+                    nearestSqr = distanceSqr;
+                    closest = candidate;
+                    normal = triangle.normal;
+                    found = true;
+                }
+            }
+        } else if (stackSize + 2 <= MaxDepth) {
+            // Visit the nearer child first so the search radius shrinks sooner.
+            int left = (int)(&node - &nodes[0]) + 1;
+            int right = node.first;
+            if (boxDistanceSqr(nodes[left].bounds, point) < boxDistanceSqr(nodes[right].bounds, point)) {
+                stack[stackSize++] = right;
+                stack[stackSize++] = left;
+            } else {
+                stack[stackSize++] = left;
+                stack[stackSize++] = right;
+            }
+        }
+    }
+
+    return found;
+}
+
+bool MeshBvh::contains(Vector3 point) const {
+    // A ray from inside a closed mesh crosses its surface an odd number of times. The direction
+    // is skewed so it's unlikely to run exactly along an edge.
+    Vector3 direction = Vector3Normalize({ 0.5773f, 0.5871f, 0.5675f });
+    float maxDistance = FLT_MAX;
+    return traceRay(point, direction, false, maxDistance) % 2 == 1;
+}
+
+float MeshBvh::getBoundingRadius() const {
+    return boundingRadius;
+}
+
+int MeshBvh::getTriangleCount() const {
+    return (int)triangles.size();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../libs/raylib/src/raylib.h"
+
+#include <vector>
+
+// Bounding volume hierarchy over the triangles of a mesh, built once when the mesh is loaded.
+// Queries are in the mesh's own (model) space, so one tree serves every instance of the mesh.
+class MeshBvh {
+    public:
+        // Uses the CPU side copy of the mesh that raylib keeps after loading.
+        MeshBvh(const Mesh& mesh);
+
+        // Nearest hit along a ray, up to `maxDistance`. `direction` must be normalized.
+        bool raycast(Vector3 origin, Vector3 direction, float maxDistance, float& hitDistance) const;
+
+        // Finds the surface point nearest to `point`, if there is one within `maxDistance`.
+        // `normal` is the normal of the triangle it's on.
+        bool closestPoint(Vector3 point, float maxDistance, Vector3& closest, Vector3& normal) const;
+
+        // Assumes the mesh is closed.
+        bool contains(Vector3 point) const;
+
+        // Distance from the origin to the furthest vertex.
+        float getBoundingRadius() const;
+        int getTriangleCount() const;
+
+    private:
+        struct Triangle {
+            Vector3 a;
+            Vector3 b;
+            Vector3 c;
+            Vector3 normal;
+        };
+
+        // Leaves have a count of triangles. Inner nodes have a count of 0, with their left child
+        // right after them and their right child at `first`.
+        struct Node {
+            BoundingBox bounds;
+            int first;
+            int count;
+        };
+
+        std::vector<Triangle> triangles;
+        std::vector<Node> nodes;
+        float boundingRadius = 0;
+
+        int build(int first, int count);
+
+        // Returns how many triangles the ray hits within `maxDistance`. With `nearestOnly` it skips
+        // hits behind the nearest one found so far, and leaves its distance in `maxDistance`.
+        int traceRay(Vector3 origin, Vector3 direction, bool nearestOnly, float& maxDistance) const;
+};
@@ -0,0 +1,256 @@
+#include "Metrics.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <psapi.h>
+#elif defined(__APPLE__)
+    #include <mach/mach.h>
+#elif defined(__linux__)
+    #include <unistd.h>
+#endif
+
+static const char* MetricPrefix = "hypersonic_";
+
+static double unixTime() {
+    using namespace std::chrono;
+    return duration<double>(system_clock::now().time_since_epoch()).count();
+}
+
+static std::string escapeString(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        if (c == '\n') {
+            escaped += "\\n";
+            continue;
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+bool parseMetricsFormat(const char* text, MetricsFormat& format) {
+    if (strcmp(text, "prometheus") == 0) {
+        format = MetricsFormat::PROMETHEUS;
+    } else if (strcmp(text, "json") == 0) {
+        format = MetricsFormat::JSON_LINES;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parseMetricsInterval(const char* text, float& seconds) {
+    char* end;
+    float value = strtof(text, &end);
+    if (end == text || *end != '\0' || !std::isfinite(value) || value <= 0)
+        return false;
+
+    seconds = value;
+    return true;
+}
+
+Metrics::Metrics(const char* build) {
+    this->build = build;
+    sessionStart = unixTime();
+}
+
+int Metrics::add(const char* name, const char* help, MetricType type) {
+    Metric metric;
+    metric.name = name;
+    metric.help = help;
+    metric.type = type;
+    metric.value = 0;
+    metric.sum = 0;
+    metric.count = 0;
+    metrics.push_back(metric);
+    return (int)metrics.size() - 1;
+}
+
+int Metrics::addCounter(const char* name, const char* help) {
+    return add(name, help, COUNTER);
+}
+
+int Metrics::addGauge(const char* name, const char* help) {
+    return add(name, help, GAUGE);
+}
+
+int Metrics::addHistogram(const char* name, const char* help, std::initializer_list<double> bounds) {
+    int index = add(name, help, HISTOGRAM);
+    metrics[index].bounds.assign(bounds.begin(), bounds.end());
+    metrics[index].buckets.assign(bounds.size(), 0);
+    return index;
+}
+
+void Metrics::increment(int counter, uint64_t amount) {
+    metrics[counter].count += amount;
+}
+
+void Metrics::set(int gauge, double value) {
+    metrics[gauge].value = value;
+}
+
+void Metrics::observe(int histogram, double value) {
+    Metric& metric = metrics[histogram];
+    metric.sum += value;
+    metric.count++;
+
+    for (size_t i = 0; i < metric.bounds.size(); ++i) {
+        if (value <= metric.bounds[i]) {
+            metric.buckets[i]++;
+            break;
+        }
+    }
+}
+
+bool Metrics::openFile(const char* path, MetricsFormat format, float interval) {
+    // Check the file can be written now rather than finding out at the first write.
+    FILE* file = fopen(path, format == MetricsFormat::JSON_LINES ? "a" : "w");
+    if (!file)
+        return false;
+    fclose(file);
+
+    this->path = path;
+    this->format = format;
+    this->interval = interval;
+    sinceWrite = 0;
+    return true;
+}
+
+bool Metrics::isOpen() const {
+    return !path.empty();
+}
+
+void Metrics::update(float deltaTime) {
+    if (path.empty())
+        return;
+
+    sinceWrite += deltaTime;
+    if (sinceWrite >= interval) {
+        sinceWrite = 0;
+        write();
+    }
+}
+
+void Metrics::write() {
+    if (path.empty())
+        return;
+
+    if (format == MetricsFormat::PROMETHEUS) {
+        writePrometheus();
+    } else {
+        writeJsonLine();
+    }
+}
+
+void Metrics::writePrometheus() {
+    // Written next to the real file and renamed over it, so readers never see half a file.
+    std::string temporaryPath = path + ".tmp";
+    FILE* file = fopen(temporaryPath.c_str(), "w");
+    if (!file)
+        return;
+
+    fprintf(file, "# HELP %sbuild_info Build and session the metrics are from.\n", MetricPrefix);
+    fprintf(file, "# TYPE %sbuild_info gauge\n", MetricPrefix);
+    fprintf(file, "%sbuild_info{build=\"%s\",session=\"%.0f\"} 1\n",
+            MetricPrefix, escapeString(build).c_str(), sessionStart);
+
+    for (auto& metric : metrics) {
+        const char* name = metric.name.c_str();
+        static const char* typeNames[] = { "counter", "gauge", "histogram" };
+        fprintf(file, "# HELP %s%s %s\n", MetricPrefix, name, metric.help.c_str());
+        fprintf(file, "# TYPE %s%s %s\n", MetricPrefix, name, typeNames[metric.type]);
+
+        if (metric.type == COUNTER) {
+            fprintf(file, "%s%s %llu\n", MetricPrefix, name, (unsigned long long)metric.count);
+        } else if (metric.type == GAUGE) {
+            fprintf(file, "%s%s %.9g\n", MetricPrefix, name, metric.value);
+        } else {
+            // Prometheus buckets count everything up to their bound, so they add up.
+            uint64_t total = 0;
+            for (size_t i = 0; i < metric.bounds.size(); ++i) {
+                total += metric.buckets[i];
+                fprintf(file, "%s%s_bucket{le=\"%.9g\"} %llu\n",
+                        MetricPrefix, name, metric.bounds[i], (unsigned long long)total);
+            }
+            fprintf(file, "%s%s_bucket{le=\"+Inf\"} %llu\n", MetricPrefix, name, (unsigned long long)metric.count);
+            fprintf(file, "%s%s_sum %.9g\n", MetricPrefix, name, metric.sum);
+            fprintf(file, "%s%s_count %llu\n", MetricPrefix, name, (unsigned long long)metric.count);
+        }
+    }
+
+    fclose(file);
+
+    // Windows won't rename over an existing file.
+#if defined(_WIN32)
+    remove(path.c_str());
+#endif
+    rename(temporaryPath.c_str(), path.c_str());
+}
+
+void Metrics::writeJsonLine() {
+    FILE* file = fopen(path.c_str(), "a");
+    if (!file)
+        return;
+
+    double now = unixTime();
+    fprintf(file, "{\"time\":%.3f,\"session\":%.0f,\"build\":\"%s\",\"uptime\":%.3f",
+            now, sessionStart, escapeString(build).c_str(), now - sessionStart);
+
+    for (auto& metric : metrics) {
+        const char* name = metric.name.c_str();
+
+        if (metric.type == COUNTER) {
+            fprintf(file, ",\"%s\":%llu", name, (unsigned long long)metric.count);
+        } else if (metric.type == GAUGE) {
+            fprintf(file, ",\"%s\":%.9g", name, metric.value);
+        } else {
+            // Unlike Prometheus, buckets only count what's between their bound and the one before.
+            fprintf(file, ",\"%s\":{\"le\":[", name);
+            for (size_t i = 0; i < metric.bounds.size(); ++i)
+                fprintf(file, "%s%.9g", i > 0 ? "," : "", metric.bounds[i]);
+            fprintf(file, "],\"buckets\":[");
+            for (size_t i = 0; i < metric.buckets.size(); ++i)
+                fprintf(file, "%s%llu", i > 0 ? "," : "", (unsigned long long)metric.buckets[i]);
+            fprintf(file, "],\"sum\":%.9g,\"count\":%llu}", metric.sum, (unsigned long long)metric.count);
+        }
+    }
+
+    fprintf(file, "}\n");
+    fclose(file);
+}
+
+size_t getResidentMemory() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.WorkingSetSize;
+    return 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS)
+        return info.resident_size;
+    return 0;
+#elif defined(__linux__)
+    // The second number is resident pages.
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (!file)
+        return 0;
+
+    unsigned long long pages = 0;
+    unsigned long long resident = 0;
+    int read = fscanf(file, "%llu %llu", &pages, &resident);
+    fclose(file);
+    return read == 2 ? (size_t)(resident * sysconf(_SC_PAGESIZE)) : 0;
+#else
+    return 0;
+#endif
+}
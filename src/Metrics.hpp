@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+// Tells runs of different builds apart in the metrics output. CMake passes the git commit when
+// it can find one.
+#if !defined(HYPERSONIC_BUILD)
+    #define HYPERSONIC_BUILD __DATE__ " " __TIME__
+#endif
+
+enum class MetricsFormat { PROMETHEUS, JSON_LINES };
+
+// For command line flags. "prometheus" or "json", and an interval of more than zero seconds.
+// Return false, leaving the result alone, for anything else.
+bool parseMetricsFormat(const char* text, MetricsFormat& format);
+bool parseMetricsInterval(const char* text, float& seconds);
+
+// Counters, gauges and histograms for long sessions and headless runs, written to a file every
+// so often so runs can be graphed and compared across builds. Metrics are registered up front
+// and updated through the handle that returns, which is an index, so updates in the frame loop
+// are a few adds and never allocate. Not thread safe.
+class Metrics {
+    public:
+        Metrics(const char* build);
+
+        // Names are snake_case and get a "hypersonic_" prefix. Counters should end in "_total"
+        // and take units as a suffix, like "_seconds" or "_bytes".
+        int addCounter(const char* name, const char* help);
+        int addGauge(const char* name, const char* help);
+
+        // Bucket upper bounds in increasing order. Anything above the last one is only counted in
+        // the total.
+        int addHistogram(const char* name, const char* help, std::initializer_list<double> bounds);
+
+        void increment(int counter, uint64_t amount = 1);
+        void set(int gauge, double value);
+        void observe(int histogram, double value);
+
+        // Prometheus text is rewritten with the latest values every time, which suits a node
+        // exporter's textfile collector. JSON lines get a line appended every time, so the file
+        // keeps the whole session.
+        bool openFile(const char* path, MetricsFormat format, float interval);
+        bool isOpen() const;
+
+        // Writes to the file when the interval is up.
+        void update(float deltaTime);
+        void write();
+
+    private:
+        enum MetricType { COUNTER, GAUGE, HISTOGRAM };
+
+        struct Metric {
+            std::string name;
+            std::string help;
+            MetricType type;
+            double value;
+            double sum;
+            uint64_t count;
+            std::vector<double> bounds;
+            std::vector<uint64_t> buckets;
+        };
+
+        std::vector<Metric> metrics;
+        std::string build;
+        double sessionStart;
+
+        std::string path;
+        MetricsFormat format = MetricsFormat::PROMETHEUS;
+        float interval = 0;
+        float sinceWrite = 0;
+
+        int add(const char* name, const char* help, MetricType type);
+        void writePrometheus();
+        void writeJsonLine();
+};
+
+// Bytes of physical memory the process is using, or 0 where that isn't known.
+size_t getResidentMemory();
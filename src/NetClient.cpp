@@ -0,0 +1,145 @@
+#include "NetClient.hpp"
+
+#include <chrono>
+
+static const double ConnectRetryInterval = 0.5;
+
+static double getSeconds() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+NetClient::NetClient() {}
+
+NetClient::~NetClient() {
+    disconnect();
+}
+
+bool NetClient::connect(const NetAddress& server) {
+    disconnect();
+
+    if (!socket.open(0))
+        return false;
+
+    this->server = server;
+    connecting = true;
+    lastConnectAttempt = 0;
+    return true;
+}
+
+void NetClient::disconnect() {
+    if (connected)
+        sendPacket(NetPacketType::DISCONNECT);
+
+    socket.close();
+    connecting = false;
+    connected = false;
+    latestTick = 0;
+    history.clear();
+}
+
+bool NetClient::update() {
+    if (connecting && !connected) {
+        double now = getSeconds();
+        if (now - lastConnectAttempt > ConnectRetryInterval) {
+            sendPacket(NetPacketType::CONNECT);
+            lastConnectAttempt = now;
+        }
+    }
+
+    uint32_t previousTick = latestTick;
+    NetAddress from;
+    int size;
+
+    while ((size = socket.receive(from, packet, sizeof(packet))) > 0) {
+        if (from != server)
+            continue;
+
+        BitReader reader(packet, size);
+        NetPacketType type;
+        if (!readPacketHeader(reader, type))
+            continue;
+
+        if (type == NetPacketType::ACCEPT && !connected) {
+            shipId = (uint16_t)reader.read(16);
+            tickInterval = 1.0f / reader.read(8);
+            connected = !reader.hasOverflowed();
+        } else if (type == NetPacketType::SNAPSHOT && connected) {
+            readSnapshot(reader, size);
+        }
+    }
+
+    return latestTick != previousTick;
+}
+
+void NetClient::readSnapshot(BitReader& reader, int packetSize) {
+    uint32_t tick = reader.read(32);
+    uint32_t baselineTick = reader.read(32);
+    shipId = (uint16_t)reader.read(16);
+
+    // Out of order packets are older than what we already have.
+    if (tick <= latestTick)
+        return;
+
+    // The server only deltas against snapshots it still remembers, so a baseline can never share
+    // a history slot with the new tick. Anything else is corrupt.
+    const NetSnapshot* baseline = &empty;
+    if (baselineTick != 0) {
+        baseline = tick - baselineTick < NetSnapshotHistorySize ? history.find(baselineTick) : nullptr;
+        if (!baseline) {
+            stats.decodeFailures++;
+            return;
+        }
+    }
+
+    NetSnapshot& snapshot = history.insert(tick);
+    if (!readSnapshotDelta(reader, *baseline, snapshot)) {
+        snapshot.tick = 0;
+        stats.decodeFailures++;
+        return;
+    }
+
+    latestTick = tick;
+    stats.snapshotsReceived++;
+    stats.bytesReceived += packetSize;
+}
+
+void NetClient::sendInput(NetInput input) {
+    if (!connected)
+        return;
+
+    input.sequence = ++inputSequence;
+    input.ackTick = latestTick;
+
+    BitWriter writer(packet, sizeof(packet));
+    writePacketHeader(writer, NetPacketType::INPUT);
+    writeInput(writer, input);
+    socket.send(server, packet, writer.finish());
+}
+
+void NetClient::sendPacket(NetPacketType type) {
+    BitWriter writer(packet, sizeof(packet));
+    writePacketHeader(writer, type);
+    socket.send(server, packet, writer.finish());
+}
+
+bool NetClient::isConnected() const {
+    return connected;
+}
+
+uint16_t NetClient::getShipId() const {
+    return shipId;
+}
+
+float NetClient::getTickInterval() const {
+    return tickInterval;
+}
+
+const NetSnapshot& NetClient::getSnapshot() const {
+    auto snapshot = history.find(latestTick);
+    return snapshot ? *snapshot : empty;
+}
+
+const NetClient::Stats& NetClient::getStats() const {
+    return stats;
+}
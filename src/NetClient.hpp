@@ -0,0 +1,64 @@
+#pragma once
+
+#include "NetProtocol.hpp"
+#include "NetSocket.hpp"
+
+#include <cstdint>
+
+// Client side of the dedicated server protocol. Sends input and keeps the newest world snapshot,
+// along with a short history of older ones that the server can send deltas against.
+class NetClient {
+    public:
+        struct Stats {
+            uint64_t snapshotsReceived = 0;
+            uint64_t bytesReceived = 0;
+            uint64_t decodeFailures = 0;
+        };
+
+        NetClient();
+        ~NetClient();
+
+        // Starts connecting. update() keeps asking until the server accepts.
+        bool connect(const NetAddress& server);
+        void disconnect();
+
+        // Reads every waiting packet. Returns true if a newer snapshot arrived.
+        bool update();
+
+        // Fills in the sequence number and acknowledges the newest snapshot received.
+        void sendInput(NetInput input);
+
+        bool isConnected() const;
+
+        // The id of the ship this client controls, as found in snapshots.
+        uint16_t getShipId() const;
+        float getTickInterval() const;
+
+        // Newest complete snapshot. Empty until the first one arrives.
+        const NetSnapshot& getSnapshot() const;
+        const Stats& getStats() const;
+
+    private:
+        UdpSocket socket;
+        NetAddress server;
+        bool connecting = false;
+        bool connected = false;
+        double lastConnectAttempt = 0;
+
+        uint16_t shipId = 0;
+        float tickInterval = 0;
+        uint32_t latestTick = 0;
+        uint32_t inputSequence = 0;
+
+        NetSnapshotHistory history;
+        NetSnapshot empty;
+        Stats stats;
+
+        uint8_t packet[NetMaxPacketSize];
+
+        void sendPacket(NetPacketType type);
+        void readSnapshot(BitReader& reader, int packetSize);
+
+        NetClient(const NetClient&);
+        NetClient& operator=(const NetClient&);
+};
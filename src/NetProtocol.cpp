@@ -0,0 +1,458 @@
+#include "NetProtocol.hpp"
+
+#include <cmath>
+#include <cstring>
+
+// Per field bits in a delta record.
+static const uint32_t FieldPosition = 1 << 0;
+static const uint32_t FieldRotation = 1 << 1;
+static const uint32_t FieldVelocity = 1 << 2;
+static const uint32_t FieldSpawnTick = 1 << 3;
+static const uint32_t FieldFlags = 1 << 4;
+static const int FieldBits = 5;
+
+enum class RecordKind : uint32_t { UPDATE, NEW, REMOVE };
+
+// Small position changes (up to 32 units) fit in 12 bits instead of 32.
+static const int SmallDeltaBits = 12;
+static const int32_t SmallDeltaLimit = (1 << (SmallDeltaBits - 1)) - 1;
+
+// Ids are usually close together, so the gap from the previous record is sent instead.
+static const int SmallIdGapBits = 6;
+
+static const int QuaternionComponentBits = 10;
+static const float QuaternionComponentMax = 0.70710678f; // 1 / sqrt(2)
+
+bool NetEntity::operator==(const NetEntity& other) const {
+    return id == other.id
+        && type == other.type
+        && flags == other.flags
+        && memcmp(position, other.position, sizeof(position)) == 0
+        && rotation == other.rotation
+        && memcmp(velocity, other.velocity, sizeof(velocity)) == 0
+        && spawnTick == other.spawnTick;
+}
+
+bool NetEntity::operator!=(const NetEntity& other) const {
+    return !(*this == other);
+}
+
+NetSnapshot& NetSnapshotHistory::insert(uint32_t tick) {
+    auto& snapshot = snapshots[tick & (NetSnapshotHistorySize - 1)];
+    snapshot.tick = tick;
+    snapshot.entities.clear();
+    return snapshot;
+}
+
+const NetSnapshot* NetSnapshotHistory::find(uint32_t tick) const {
+    auto& snapshot = snapshots[tick & (NetSnapshotHistorySize - 1)];
+    if (tick == 0 || snapshot.tick != tick)
+        return nullptr;
+    return &snapshot;
+}
+
+void NetSnapshotHistory::clear() {
+    for (auto& snapshot : snapshots) {
+        snapshot.tick = 0;
+        snapshot.entities.clear();
+    }
+}
+
+NetIdAllocator::NetIdAllocator() {
+    memset(used, 0, sizeof(used));
+}
+
+uint16_t NetIdAllocator::allocate() {
+    if (usedCount == idCount - 1)
+        return 0;
+
+    // 0 is never handed out.
+    while (next == 0 || isUsed(next))
+        next++;
+
+    uint16_t id = next++;
+    used[id / 64] |= (uint64_t)1 << (id % 64);
+    usedCount++;
+    return id;
+}
+
+void NetIdAllocator::release(uint16_t id) {
+    if (id == 0 || !isUsed(id))
+        return;
+
+    used[id / 64] &= ~((uint64_t)1 << (id % 64));
+    usedCount--;
+}
+
+bool NetIdAllocator::isUsed(uint16_t id) const {
+    return (used[id / 64] >> (id % 64)) & 1;
+}
+
+int NetIdAllocator::getUsedCount() const {
+    return usedCount;
+}
+
+BitWriter::BitWriter(uint8_t* buffer, int capacity) {
+    this->buffer = buffer;
+    this->capacity = capacity;
+}
+
+void BitWriter::write(uint32_t value, int bits) {
+    if (bits < 32)
+        value &= (1u << bits) - 1;
+
+    scratch |= (uint64_t)value << scratchBits;
+    scratchBits += bits;
+
+    while (scratchBits >= 8) {
+        if (bytes < capacity) {
+            buffer[bytes++] = (uint8_t)scratch;
+        } else {
+            overflowed = true;
+        }
+        scratch >>= 8;
+        scratchBits -= 8;
+    }
+}
+
+void BitWriter::writeSigned(int32_t value, int bits) {
+    write((uint32_t)value, bits);
+}
+
+int BitWriter::finish() {
+    if (scratchBits > 0)
+        write(0, 8 - scratchBits);
+    return bytes;
+}
+
+bool BitWriter::hasOverflowed() const {
+    return overflowed;
+}
+
+BitReader::BitReader(const uint8_t* buffer, int size) {
+    this->buffer = buffer;
+    this->size = size;
+}
+
+uint32_t BitReader::read(int bits) {
+    while (scratchBits < bits) {
+        if (bytes < size) {
+            scratch |= (uint64_t)buffer[bytes++] << scratchBits;
+        } else {
+            overflowed = true;
+        }
+        scratchBits += 8;
+    }
+
+    uint32_t value = (uint32_t)(bits < 32 ? scratch & ((1ull << bits) - 1) : scratch);
+    scratch >>= bits;
+    scratchBits -= bits;
+    return value;
+}
+
+int32_t BitReader::readSigned(int bits) {
+    uint32_t value = read(bits);
+    if (bits < 32 && (value & (1u << (bits - 1))))
+        value |= ~((1u << bits) - 1);
+    return (int32_t)value;
+}
+
+bool BitReader::hasOverflowed() const {
+    return overflowed;
+}
+
+int32_t quantizePosition(float value) {
+    return (int32_t)lroundf(value * NetPositionScale);
+}
+
+float dequantizePosition(int32_t value) {
+    return value / NetPositionScale;
+}
+
+int16_t quantizeVelocity(float value) {
+    float scaled = roundf(value * NetVelocityScale);
+    if (scaled > INT16_MAX) scaled = INT16_MAX;
+    if (scaled < INT16_MIN) scaled = INT16_MIN;
+    return (int16_t)scaled;
+}
+
+float dequantizeVelocity(int16_t value) {
+    return value / NetVelocityScale;
+}
+
+uint32_t packQuaternion(Quaternion q) {
+    float components[4] = { q.x, q.y, q.z, q.w };
+
+    int largest = 0;
+    for (int i = 1; i < 4; ++i) {
+        if (fabsf(components[i]) > fabsf(components[largest]))
+            largest = i;
+    }
+
+    // q and -q are the same rotation, so the dropped component can always be made positive.
+    float sign = components[largest] < 0 ? -1.0f : 1.0f;
+    const uint32_t maxValue = (1u << QuaternionComponentBits) - 1;
+
+    uint32_t packed = (uint32_t)largest;
+    for (int i = 0; i < 4; ++i) {
+        if (i == largest)
+            continue;
+
+        float normalized = (components[i] * sign / QuaternionComponentMax) * 0.5f + 0.5f;
+        float scaled = roundf(normalized * maxValue);
+        if (scaled < 0) scaled = 0;
+        if (scaled > maxValue) scaled = (float)maxValue;
+
+        packed = (packed << QuaternionComponentBits) | (uint32_t)scaled;
+    }
+
+    return packed;
+}
+
+Quaternion unpackQuaternion(uint32_t packed) {
+    const uint32_t maxValue = (1u << QuaternionComponentBits) - 1;
+    int largest = (int)(packed >> (QuaternionComponentBits * 3));
+
+    float components[4];
+    float sumOfSquares = 0;
+    int shift = QuaternionComponentBits * 2;
+    for (int i = 0; i < 4; ++i) {
+        if (i == largest)
+            continue;
+
+        uint32_t value = (packed >> shift) & maxValue;
+        shift -= QuaternionComponentBits;
+
+        components[i] = ((value / (float)maxValue) - 0.5f) * 2.0f * QuaternionComponentMax;
+        sumOfSquares += components[i] * components[i];
+    }
+
+    components[largest] = sqrtf(fmaxf(0.0f, 1.0f - sumOfSquares));
+    return Quaternion{ components[0], components[1], components[2], components[3] };
+}
+
+Vector3 getNetEntityPosition(const NetEntity& entity, uint32_t tick, float tickInterval) {
+    Vector3 position = {
+        dequantizePosition(entity.position[0]),
+        dequantizePosition(entity.position[1]),
+        dequantizePosition(entity.position[2])
+    };
+
+    if (entity.spawnTick == 0 || tick <= entity.spawnTick)
+        return position;
+
+    float age = (tick - entity.spawnTick) * tickInterval;
+    position.x += dequantizeVelocity(entity.velocity[0]) * age;
+    position.y += dequantizeVelocity(entity.velocity[1]) * age;
+    position.z += dequantizeVelocity(entity.velocity[2]) * age;
+    return position;
+}
+
+void writePacketHeader(BitWriter& writer, NetPacketType type) {
+    writer.write(NetProtocolId, 32);
+    writer.write((uint32_t)type, 8);
+}
+
+bool readPacketHeader(BitReader& reader, NetPacketType& type) {
+    if (reader.read(32) != NetProtocolId)
+        return false;
+
+    type = (NetPacketType)reader.read(8);
+    return !reader.hasOverflowed();
+}
+
+void writeInput(BitWriter& writer, const NetInput& input) {
+    writer.write(input.sequence, 32);
+    writer.write(input.ackTick, 32);
+    writer.writeSigned(input.yawLeft, 8);
+    writer.writeSigned(input.pitchDown, 8);
+    writer.writeSigned(input.rollRight, 8);
+    writer.write(input.buttons, 8);
+}
+
+void readInput(BitReader& reader, NetInput& input) {
+    input.sequence = reader.read(32);
+    input.ackTick = reader.read(32);
+    input.yawLeft = (int8_t)reader.readSigned(8);
+    input.pitchDown = (int8_t)reader.readSigned(8);
+    input.rollRight = (int8_t)reader.readSigned(8);
+    input.buttons = (uint8_t)reader.read(8);
+}
+
+static void writeFields(BitWriter& writer, const NetEntity& baseline, const NetEntity& entity) {
+    uint32_t fields = 0;
+    if (memcmp(baseline.position, entity.position, sizeof(entity.position)) != 0) fields |= FieldPosition;
+    if (baseline.rotation != entity.rotation) fields |= FieldRotation;
+    if (memcmp(baseline.velocity, entity.velocity, sizeof(entity.velocity)) != 0) fields |= FieldVelocity;
+    if (baseline.spawnTick != entity.spawnTick) fields |= FieldSpawnTick;
+    if (baseline.flags != entity.flags) fields |= FieldFlags;
+
+    writer.write(fields, FieldBits);
+
+    if (fields & FieldPosition) {
+        for (int i = 0; i < 3; ++i) {
+            int64_t delta = (int64_t)entity.position[i] - baseline.position[i];
+            if (delta >= -SmallDeltaLimit && delta <= SmallDeltaLimit) {
+                writer.write(0, 1);
+                writer.writeSigned((int32_t)delta, SmallDeltaBits);
+            } else {
+                writer.write(1, 1);
+                writer.writeSigned(entity.position[i], 32);
+            }
+        }
+    }
+
+    if (fields & FieldRotation)
+        writer.write(entity.rotation, 32);
+
+    if (fields & FieldVelocity) {
+        for (int i = 0; i < 3; ++i)
+            writer.writeSigned(entity.velocity[i], 16);
+    }
+
+    if (fields & FieldSpawnTick)
+        writer.write(entity.spawnTick, 32);
+
+    if (fields & FieldFlags)
+        writer.write(entity.flags, 8);
+}
+
+static void readFields(BitReader& reader, NetEntity& entity) {
+    uint32_t fields = reader.read(FieldBits);
+
+    if (fields & FieldPosition) {
+        for (int i = 0; i < 3; ++i) {
+            if (reader.read(1) == 0) {
+                entity.position[i] += reader.readSigned(SmallDeltaBits);
+            } else {
+                entity.position[i] = reader.readSigned(32);
+            }
+        }
+    }
+
+    if (fields & FieldRotation)
+        entity.rotation = reader.read(32);
+
+    if (fields & FieldVelocity) {
+        for (int i = 0; i < 3; ++i)
+            entity.velocity[i] = (int16_t)reader.readSigned(16);
+    }
+
+    if (fields & FieldSpawnTick)
+        entity.spawnTick = reader.read(32);
+
+    if (fields & FieldFlags)
+        entity.flags = (uint8_t)reader.read(8);
+}
+
+static void writeRecordHeader(BitWriter& writer, uint16_t& lastId, uint16_t id, RecordKind kind) {
+    writer.write(1, 1);
+
+    uint32_t gap = (uint32_t)(id - lastId);
+    if (gap < (1u << SmallIdGapBits)) {
+        writer.write(0, 1);
+        writer.write(gap, SmallIdGapBits);
+    } else {
+        writer.write(1, 1);
+        writer.write(id, 16);
+    }
+    lastId = id;
+
+    writer.write((uint32_t)kind, 2);
+}
+
+void writeSnapshotDelta(BitWriter& writer, const NetSnapshot& baseline, const NetSnapshot& current) {
+    uint16_t lastId = 0;
+    size_t b = 0;
+    size_t c = 0;
+    const NetEntity empty;
+
+    // Both lists are sorted by id, so walking them together finds additions and removals.
+    while (b < baseline.entities.size() || c < current.entities.size()) {
+        const NetEntity* base = b < baseline.entities.size() ? &baseline.entities[b] : nullptr;
+        const NetEntity* entity = c < current.entities.size() ? &current.entities[c] : nullptr;
+
+        if (entity && (!base || entity->id < base->id)) {
+            writeRecordHeader(writer, lastId, entity->id, RecordKind::NEW);
+            writer.write((uint32_t)entity->type, 2);
+            writeFields(writer, empty, *entity);
+            ++c;
+        } else if (base && (!entity || base->id < entity->id)) {
+            writeRecordHeader(writer, lastId, base->id, RecordKind::REMOVE);
+            ++b;
+        } else if (entity->type != base->type) {
+            // The id was reused by something else (ids wrap around eventually).
+            writeRecordHeader(writer, lastId, base->id, RecordKind::REMOVE);
+            writeRecordHeader(writer, lastId, entity->id, RecordKind::NEW);
+            writer.write((uint32_t)entity->type, 2);
+            writeFields(writer, empty, *entity);
+            ++b;
+            ++c;
+        } else {
+            if (*entity != *base) {
+                writeRecordHeader(writer, lastId, entity->id, RecordKind::UPDATE);
+                writeFields(writer, *base, *entity);
+            }
+            ++b;
+            ++c;
+        }
+    }
+
+    writer.write(0, 1);
+}
+
+bool readSnapshotDelta(BitReader& reader, const NetSnapshot& baseline, NetSnapshot& result) {
+    result.entities.clear();
+
+    uint16_t lastId = 0;
+    size_t b = 0;
+
+    while (reader.read(1) == 1) {
+        uint16_t id;
+        if (reader.read(1) == 0) {
+            id = (uint16_t)(lastId + reader.read(SmallIdGapBits));
+        } else {
+            id = (uint16_t)reader.read(16);
+        }
+        lastId = id;
+
+        auto kind = (RecordKind)reader.read(2);
+        if (reader.hasOverflowed())
+            return false;
+
+        // Everything in the baseline before this id is unchanged.
+        while (b < baseline.entities.size() && baseline.entities[b].id < id)
+            result.entities.push_back(baseline.entities[b++]);
+
+        bool inBaseline = b < baseline.entities.size() && baseline.entities[b].id == id;
+
+        if (kind == RecordKind::NEW) {
+            if (inBaseline)
+                return false;
+
+            NetEntity entity;
+            entity.id = id;
+            entity.type = (NetEntityType)reader.read(2);
+            readFields(reader, entity);
+            result.entities.push_back(entity);
+        } else if (kind == RecordKind::UPDATE) {
+            if (!inBaseline)
+                return false;
+
+            NetEntity entity = baseline.entities[b++];
+            readFields(reader, entity);
+            result.entities.push_back(entity);
+        } else if (kind == RecordKind::REMOVE) {
+            if (!inBaseline)
+                return false;
+            ++b;
+        } else {
+            return false;
+        }
+    }
+
+    while (b < baseline.entities.size())
+        result.entities.push_back(baseline.entities[b++]);
+
+    return !reader.hasOverflowed();
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "../libs/raylib/src/raylib.h"
+
+#include <cstdint>
+#include <vector>
+
+// ==================================================================================
+// Wire format shared by the dedicated server and its clients. Snapshots are sent as
+// deltas against the newest snapshot the client has acknowledged, with quantized
+// positions and smallest-three quaternions.
+// ==================================================================================
+
+static const uint32_t NetProtocolId = 0x48595052; // "HYPR"
+static const uint16_t NetDefaultPort = 27015;
+static const int NetMaxPacketSize = 8192;
+
+// Number of snapshots either side remembers for use as delta baselines. Must be a power of two.
+static const int NetSnapshotHistorySize = 64;
+
+// Positions are sent in 1/64ths of a unit, velocities in 1/8ths of a unit per second.
+static const float NetPositionScale = 64.0f;
+static const float NetVelocityScale = 8.0f;
+
+enum class NetPacketType : uint8_t {
+    CONNECT = 1,
+    ACCEPT,
+    INPUT,
+    SNAPSHOT,
+    DISCONNECT
+};
+
+enum class NetEntityType : uint8_t {
+    SHIP,
+    BULLET,
+    ASTEROID
+};
+
+static const uint8_t NetButtonFire = 1;
+
+struct NetInput {
+    uint32_t sequence = 0;
+    // Newest snapshot tick the client has received, so the server can delta against it.
+    uint32_t ackTick = 0;
+    int8_t yawLeft = 0;
+    int8_t pitchDown = 0;
+    int8_t rollRight = 0;
+    uint8_t buttons = 0;
+};
+
+// Bullets and asteroids fly in straight lines, so they're sent as where they were at `spawnTick`
+// plus their velocity. That way they never change after being created and cost nothing per tick.
+struct NetEntity {
+    uint16_t id = 0;
+    NetEntityType type = NetEntityType::SHIP;
+    uint8_t flags = 0;
+    int32_t position[3] = { 0, 0, 0 };
+    uint32_t rotation = 0;
+    int16_t velocity[3] = { 0, 0, 0 };
+    uint32_t spawnTick = 0;
+
+    bool operator==(const NetEntity& other) const;
+    bool operator!=(const NetEntity& other) const;
+};
+
+struct NetSnapshot {
+    uint32_t tick = 0;
+    std::vector<NetEntity> entities; // Sorted by id.
+};
+
+// Ring of recent snapshots, indexed by tick.
+class NetSnapshotHistory {
+    public:
+        // Returns the slot for `tick`, reusing whichever snapshot was there before.
+        NetSnapshot& insert(uint32_t tick);
+        const NetSnapshot* find(uint32_t tick) const;
+        void clear();
+
+    private:
+        NetSnapshot snapshots[NetSnapshotHistorySize];
+};
+
+// Hands out entity ids that nothing live holds. The search for a free id carries on from the
+// last one handed out, so a released id only comes back after every other free id has been
+// used, long after any client stops holding a snapshot with the old entity.
+class NetIdAllocator {
+    public:
+        NetIdAllocator();
+
+        // Returns 0, which means "no entity" on the wire, if every id is in use.
+        uint16_t allocate();
+        void release(uint16_t id);
+
+        bool isUsed(uint16_t id) const;
+        int getUsedCount() const;
+
+    private:
+        static const int idCount = 65536;
+
+        uint64_t used[idCount / 64];
+        int usedCount = 0;
+        uint16_t next = 1;
+};
+
+class BitWriter {
+    public:
+        BitWriter(uint8_t* buffer, int capacity);
+
+        void write(uint32_t value, int bits);
+        void writeSigned(int32_t value, int bits);
+
+        // Flushes any partial byte and returns the number of bytes written.
+        int finish();
+        bool hasOverflowed() const;
+
+    private:
+        uint8_t* buffer;
+        int capacity;
+        int bytes = 0;
+        uint64_t scratch = 0;
+        int scratchBits = 0;
+        bool overflowed = false;
+};
+
+class BitReader {
+    public:
+        BitReader(const uint8_t* buffer, int size);
+
+        uint32_t read(int bits);
+        int32_t readSigned(int bits);
+
+        // Reading past the end returns zeros and sets this, so callers can check once at the end.
+        bool hasOverflowed() const;
+
+    private:
+        const uint8_t* buffer;
+        int size;
+        int bytes = 0;
+        uint64_t scratch = 0;
+        int scratchBits = 0;
+        bool overflowed = false;
+};
+
+int32_t quantizePosition(float value);
+float dequantizePosition(int32_t value);
+int16_t quantizeVelocity(float value);
+float dequantizeVelocity(int16_t value);
+
+// Drops the largest component, which can be rebuilt from the other three. 2 bits say which one
+// was dropped and each of the others gets 10 bits.
+uint32_t packQuaternion(Quaternion q);
+Quaternion unpackQuaternion(uint32_t packed);
+
+// Where an entity is at `tick`, extrapolating bullets and asteroids from where they spawned.
+Vector3 getNetEntityPosition(const NetEntity& entity, uint32_t tick, float tickInterval);
+
+void writePacketHeader(BitWriter& writer, NetPacketType type);
+// Returns false if the packet isn't one of ours.
+bool readPacketHeader(BitReader& reader, NetPacketType& type);
+
+void writeInput(BitWriter& writer, const NetInput& input);
+void readInput(BitReader& reader, NetInput& input);
+
+// Writes only the entities in `current` that were added, removed or changed since `baseline`.
+// An empty baseline sends everything.
+void writeSnapshotDelta(BitWriter& writer, const NetSnapshot& baseline, const NetSnapshot& current);
+
+// Rebuilds a full snapshot from `baseline` and a delta. `result.tick` is left to the caller.
+// Returns false if the delta doesn't fit the baseline.
+bool readSnapshotDelta(BitReader& reader, const NetSnapshot& baseline, NetSnapshot& result);
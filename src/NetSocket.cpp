@@ -0,0 +1,158 @@
+#include "NetSocket.hpp"
+
+#if defined(_WIN32)
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    typedef int socklen_t;
+    typedef SOCKET SocketHandle;
+#else
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+    typedef int SocketHandle;
+#endif
+
+#include <cstring>
+
+static const intptr_t InvalidHandle = -1;
+
+#if defined(_WIN32)
+// Winsock has to be started before any socket call and there's no good place for that in the
+// game, so it's tied to the lifetime of the program.
+struct WinsockInit {
+    WinsockInit() {
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+    }
+
+    ~WinsockInit() {
+        WSACleanup();
+    }
+};
+
+static WinsockInit winsockInit;
+#endif
+
+bool NetAddress::operator==(const NetAddress& other) const {
+    return host == other.host && port == other.port;
+}
+
+bool NetAddress::operator!=(const NetAddress& other) const {
+    return !(*this == other);
+}
+
+bool resolveAddress(const char* hostName, uint16_t port, NetAddress& address) {
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    addrinfo* result = nullptr;
+    if (getaddrinfo(hostName, nullptr, &hints, &result) != 0 || result == nullptr)
+        return false;
+
+    auto ipv4 = (const sockaddr_in*)result->ai_addr;
+    address.host = ntohl(ipv4->sin_addr.s_addr);
+    address.port = port;
+
+    freeaddrinfo(result);
+    return true;
+}
+
+UdpSocket::UdpSocket() {
+    handle = InvalidHandle;
+}
+
+UdpSocket::~UdpSocket() {
+    close();
+}
+
+bool UdpSocket::open(uint16_t port) {
+    close();
+
+    auto s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+#if defined(_WIN32)
+    if (s == INVALID_SOCKET)
+        return false;
+#else
+    if (s < 0)
+        return false;
+#endif
+    handle = (intptr_t)s;
+
+    sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(port);
+
+    if (bind(s, (const sockaddr*)&local, sizeof(local)) != 0) {
+        close();
+        return false;
+    }
+
+#if defined(_WIN32)
+    u_long nonBlocking = 1;
+    bool ok = ioctlsocket(s, FIONBIO, &nonBlocking) == 0;
+#else
+    bool ok = fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+
+    if (!ok) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void UdpSocket::close() {
+    if (handle == InvalidHandle)
+        return;
+
+#if defined(_WIN32)
+    closesocket((SocketHandle)handle);
+#else
+    ::close((SocketHandle)handle);
+#endif
+    handle = InvalidHandle;
+}
+
+bool UdpSocket::isOpen() const {
+    return handle != InvalidHandle;
+}
+
+bool UdpSocket::send(const NetAddress& to, const void* data, int size) {
+    if (handle == InvalidHandle)
+        return false;
+
+    sockaddr_in remote;
+    memset(&remote, 0, sizeof(remote));
+    remote.sin_family = AF_INET;
+    remote.sin_addr.s_addr = htonl(to.host);
+    remote.sin_port = htons(to.port);
+
+    auto sent = sendto((SocketHandle)handle, (const char*)data, size, 0, (const sockaddr*)&remote, sizeof(remote));
+    return sent == size;
+}
+
+int UdpSocket::receive(NetAddress& from, void* data, int capacity) {
+    if (handle == InvalidHandle)
+        return 0;
+
+    sockaddr_in remote;
+    socklen_t remoteSize = sizeof(remote);
+    auto received = recvfrom((SocketHandle)handle, (char*)data, capacity, 0, (sockaddr*)&remote, &remoteSize);
+
+    // Would-block and errors (like ICMP port unreachable on Windows) are both treated as "nothing
+    // to read" since there's nothing useful a caller could do about either.
+    if (received <= 0)
+        return 0;
+
+    from.host = ntohl(remote.sin_addr.s_addr);
+    from.port = ntohs(remote.sin_port);
+    return (int)received;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+// IPv4 address and port, both kept in host byte order.
+struct NetAddress {
+    uint32_t host = 0;
+    uint16_t port = 0;
+
+    bool operator==(const NetAddress& other) const;
+    bool operator!=(const NetAddress& other) const;
+};
+
+// Resolves "127.0.0.1" or "localhost" style names. Returns false if the name can't be resolved.
+bool resolveAddress(const char* hostName, uint16_t port, NetAddress& address);
+
+// A non-blocking UDP socket. This deliberately doesn't include any platform headers so it can be
+// used from files that include raylib, which clashes with windows.h.
+class UdpSocket {
+    public:
+        UdpSocket();
+        ~UdpSocket();
+
+        // Binds to `port` on all interfaces. Port 0 picks any free port, which is what clients use.
+        bool open(uint16_t port);
+        void close();
+        bool isOpen() const;
+
+        bool send(const NetAddress& to, const void* data, int size);
+
+        // Returns the number of bytes received, or 0 if nothing is waiting.
+        int receive(NetAddress& from, void* data, int capacity);
+
+    private:
+        intptr_t handle;
+
+        UdpSocket(const UdpSocket&);
+        UdpSocket& operator=(const UdpSocket&);
+};
@@ -0,0 +1,241 @@
+#include "ParticleSystem.hpp"
+
+#include "../libs/raylib/src/raymath.h"
+#include "../libs/raylib/src/rlgl.h"
+
+#include "SimdMath.hpp"
+
+#include <cstring>
+
+// Two triangles facing the camera, as corners from -1 to 1.
+static const float QuadCorners[] = {
+    -1, -1,   1, -1,   1,  1,
+    -1, -1,   1,  1,  -1,  1,
+};
+
+static const char* AttributeNames[] = {
+    "quadCorner", "particleX", "particleY", "particleZ", "particleFade", "particleColor"
+};
+
+static uint32_t packColor(Color color) {
+    uint32_t packed;
+    memcpy(&packed, &color, sizeof(packed));
+    return packed;
+}
+
+ParticleSystem::ParticleSystem(int capacity) : random(0x5eed) {
+    this->capacity = capacity;
+    int padded = (capacity + 3) & ~3;
+
+    positionX.resize(padded);
+    positionY.resize(padded);
+    positionZ.resize(padded);
+    velocityX.resize(padded);
+    velocityY.resize(padded);
+    velocityZ.resize(padded);
+    life.resize(padded);
+    inverseLifetime.resize(padded);
+    fade.resize(padded);
+    colors.resize(padded);
+}
+
+ParticleSystem::~ParticleSystem() {
+    if (shader.id == 0)
+        return;
+
+    UnloadShader(shader);
+    rlUnloadVertexArray(vertexArray);
+    rlUnloadVertexBuffer(quadBuffer);
+    for (unsigned int buffer : instanceBuffers)
+        rlUnloadVertexBuffer(buffer);
+}
+
+void ParticleSystem::loadRenderer(int glslVersion) {
+    shader = LoadShader(TextFormat("assets/shaders/glsl%i/particle.vs", glslVersion),
+                        TextFormat("assets/shaders/glsl%i/particle.fs", glslVersion));
+    viewLocation = GetShaderLocation(shader, "matView");
+    projectionLocation = GetShaderLocation(shader, "matProjection");
+    sizeLocation = GetShaderLocation(shader, "particleSize");
+    for (int i = 0; i <= instanceBufferCount; ++i)
+        attributeLocations[i] = rlGetLocationAttrib(shader.id, AttributeNames[i]);
+
+    quadBuffer = rlLoadVertexBuffer(QuadCorners, sizeof(QuadCorners), false);
+    for (int i = 0; i < instanceBufferCount; ++i)
+        instanceBuffers[i] = rlLoadVertexBuffer(nullptr, capacity * 4, true);
+
+    // Where vertex arrays aren't supported (some WebGL 1 browsers) the attributes are bound at
+    // every draw instead.
+    vertexArray = rlLoadVertexArray();
+    if (rlEnableVertexArray(vertexArray)) {
+        bindAttributes();
+        rlDisableVertexArray();
+    }
+}
+
+void ParticleSystem::emit(Vector3 position, Vector3 velocity, float lifetime, Color color) {
+    if (count >= capacity) {
+        dropped++;
+        return;
+    }
+
+    int i = count++;
+    positionX[i] = position.x;
+    positionY[i] = position.y;
+    positionZ[i] = position.z;
+    velocityX[i] = velocity.x;
+    velocityY[i] = velocity.y;
+    velocityZ[i] = velocity.z;
+    life[i] = lifetime;
+    inverseLifetime[i] = 1 / lifetime;
+    fade[i] = 1;
+    colors[i] = packColor(color);
+}
+
+void ParticleSystem::emitBurst(Vector3 position, Vector3 velocity, int count, float speed,
+                               float lifetime, Color color) {
+    for (int i = 0; i < count; ++i) {
+        // Directions from inside a ball, so the burst is round and some sparks are slow.
+        Vector3 direction;
+        do {
+            direction = { random.rangeFloat(-1, 1), random.rangeFloat(-1, 1), random.rangeFloat(-1, 1) };
+        } while (Vector3LengthSqr(direction) > 1);
+
+        emit(position, addScaled(velocity, direction, speed), lifetime * (0.5f + 0.5f * random.rangeFloat(0, 1)), color);
+    }
+}
+
+void ParticleSystem::emitStream(Vector3 position, Vector3 velocity, float rate, float spread,
+                                float lifetime, Color color, float deltaTime) {
+    // Rounded up or down at random so low rates still average out right.
+    int count = (int)(rate * deltaTime + random.rangeFloat(0, 1));
+    emitBurst(position, velocity, count, spread, lifetime, color);
+}
+
+void ParticleSystem::update(float deltaTime) {
+    Float4 step = splatFloat4(deltaTime);
+    Float4 damping = splatFloat4(fastExp(-drag * deltaTime));
+
+    // Four particles at a time. Lanes past the end are padding or dead particles, and nothing
+    // reads what's written to them.
+    for (int i = 0; i < count; i += 4) {
+        Float4 vx = mul4(loadFloat4(&velocityX[i]), damping);
+        Float4 vy = mul4(loadFloat4(&velocityY[i]), damping);
+        Float4 vz = mul4(loadFloat4(&velocityZ[i]), damping);
+        storeFloat4(&velocityX[i], vx);
+        storeFloat4(&velocityY[i], vy);
+        storeFloat4(&velocityZ[i], vz);
+
+        storeFloat4(&positionX[i], add4(loadFloat4(&positionX[i]), mul4(vx, step)));
+        storeFloat4(&positionY[i], add4(loadFloat4(&positionY[i]), mul4(vy, step)));
+        storeFloat4(&positionZ[i], add4(loadFloat4(&positionZ[i]), mul4(vz, step)));
+
+        Float4 remaining = sub4(loadFloat4(&life[i]), step);
+        storeFloat4(&life[i], remaining);
+        storeFloat4(&fade[i], mul4(remaining, loadFloat4(&inverseLifetime[i])));
+    }
+
+    // Dead particles are replaced by the last live one, which keeps the live ones packed.
+    for (int i = 0; i < count;) {
+        if (life[i] > 0) {
+            ++i;
+            continue;
+        }
+
+        int last = --count;
+        positionX[i] = positionX[last];
+        positionY[i] = positionY[last];
+        positionZ[i] = positionZ[last];
+        velocityX[i] = velocityX[last];
+        velocityY[i] = velocityY[last];
+        velocityZ[i] = velocityZ[last];
+        life[i] = life[last];
+        inverseLifetime[i] = inverseLifetime[last];
+        fade[i] = fade[last];
+        colors[i] = colors[last];
+    }
+}
+
+void ParticleSystem::upload() {
+    uploadedCount = 0;
+    if (shader.id == 0 || count == 0)
+        return;
+
+    const void* arrays[instanceBufferCount] = {
+        positionX.data(), positionY.data(), positionZ.data(), fade.data(), colors.data()
+    };
+    for (int i = 0; i < instanceBufferCount; ++i)
+        rlUpdateVertexBuffer(instanceBuffers[i], arrays[i], count * 4, 0);
+
+    uploadedCount = count;
+}
+
+void ParticleSystem::draw() const {
+    if (uploadedCount == 0)
+        return;
+
+    // This draws outside of rlgl's batch, so whatever is batched has to go first.
+    rlDrawRenderBatchActive();
+
+    rlEnableShader(shader.id);
+    rlSetUniformMatrix(viewLocation, rlGetMatrixModelview());
+    rlSetUniformMatrix(projectionLocation, rlGetMatrixProjection());
+    rlSetUniform(sizeLocation, &size, RL_SHADER_UNIFORM_FLOAT, 1);
+
+    if (rlEnableVertexArray(vertexArray)) {
+        rlDrawVertexArrayInstanced(0, 6, uploadedCount);
+        rlDisableVertexArray();
+    } else {
+        bindAttributes();
+        rlDrawVertexArrayInstanced(0, 6, uploadedCount);
+        unbindAttributes();
+    }
+
+    rlDisableShader();
+}
+
+void ParticleSystem::bindAttributes() const {
+    if (attributeLocations[0] >= 0) {
+        rlEnableVertexBuffer(quadBuffer);
+        rlSetVertexAttribute(attributeLocations[0], 2, RL_FLOAT, false, 0, 0);
+        rlEnableVertexAttribute(attributeLocations[0]);
+    }
+
+    // The rest advance once per particle rather than once per vertex.
+    for (int i = 0; i < instanceBufferCount; ++i) {
+        int location = attributeLocations[i + 1];
+        if (location < 0)
+            continue;
+
+        bool isColor = i == instanceBufferCount - 1;
+        rlEnableVertexBuffer(instanceBuffers[i]);
+        rlSetVertexAttribute(location, isColor ? 4 : 1, isColor ? RL_UNSIGNED_BYTE : RL_FLOAT, isColor, 0, 0);
+        rlEnableVertexAttribute(location);
+        rlSetVertexAttributeDivisor(location, 1);
+    }
+
+    rlDisableVertexBuffer();
+}
+
+void ParticleSystem::unbindAttributes() const {
+    // Raylib's own draws expect every attribute to advance per vertex.
+    for (int i = 0; i <= instanceBufferCount; ++i) {
+        if (attributeLocations[i] < 0)
+            continue;
+
+        if (i > 0)
+            rlSetVertexAttributeDivisor(attributeLocations[i], 0);
+        rlDisableVertexAttribute(attributeLocations[i]);
+    }
+}
+
+int ParticleSystem::getCount() const {
+    return count;
+}
+
+int ParticleSystem::getCapacity() const {
+    return capacity;
+}
+
+int ParticleSystem::getDropped() const {
+    return dropped;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "../libs/raylib/src/raylib.h"
+
+#include "Random.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Short lived additive sparks for explosions and engine exhaust. Each particle field has its own
+// array (structure of arrays) with the live particles packed at the front, so the update works
+// on four particles at a time and the arrays go to the GPU as they are. Everything is drawn with
+// one instanced draw of a camera facing quad. Particles are only visual, so they aren't part of
+// the world state and don't rewind.
+class ParticleSystem {
+    public:
+        // Fraction of their speed particles lose per second.
+        float drag = 1.5f;
+        // Width of a particle at full brightness. They shrink as they fade.
+        float size = 0.15f;
+
+        // Nothing is allocated after this. Particles emitted while full are dropped.
+        ParticleSystem(int capacity);
+        ~ParticleSystem();
+
+        // Loads the shader and GPU buffers. Needs a window, and has to be done before upload() and
+        // draw(). Without it the system still simulates, which is all benchmarks need.
+        void loadRenderer(int glslVersion);
+
+        void emit(Vector3 position, Vector3 velocity, float lifetime, Color color);
+
+        // `count` particles from `position`, going up to `speed` in random directions on top of
+        // `velocity`. Lifetimes vary between half and all of `lifetime`.
+        void emitBurst(Vector3 position, Vector3 velocity, int count, float speed, float lifetime, Color color);
+
+        // A steady stream of `rate` particles a second, spreading out at up to `spread`. Call every
+        // frame the stream is on.
+        void emitStream(Vector3 position, Vector3 velocity, float rate, float spread, float lifetime,
+                        Color color, float deltaTime);
+
+        // Moves, slows and fades every particle, then removes the ones that have died.
+        void update(float deltaTime);
+
+        // Copies the particles to the GPU. Call once a frame, after update() and before draw().
+        void upload();
+
+        // Expects RenderPass::ADDITIVE_PASS state and a 3D camera.
+        void draw() const;
+
+        int getCount() const;
+        int getCapacity() const;
+
+        // Particles dropped for lack of room since the system was made.
+        int getDropped() const;
+
+    private:
+        // Arrays are padded to a multiple of four so the update never needs a scalar tail.
+        int capacity;
+        int count = 0;
+        int dropped = 0;
+
+        std::vector<float> positionX;
+        std::vector<float> positionY;
+        std::vector<float> positionZ;
+        std::vector<float> velocityX;
+        std::vector<float> velocityY;
+        std::vector<float> velocityZ;
+        std::vector<float> life;
+        std::vector<float> inverseLifetime;
+        // Life left as a fraction, from 1 down to 0.
+        std::vector<float> fade;
+        // RGBA bytes, the way the shader reads them.
+        std::vector<uint32_t> colors;
+
+        Random random;
+
+        Shader shader = {};
+        int viewLocation = -1;
+        int projectionLocation = -1;
+        int sizeLocation = -1;
+        unsigned int vertexArray = 0;
+        unsigned int quadBuffer = 0;
+        // Position x, y, z, fade and color, one value per particle.
+        static const int instanceBufferCount = 5;
+        unsigned int instanceBuffers[instanceBufferCount] = {};
+        int attributeLocations[instanceBufferCount + 1] = {};
+        int uploadedCount = 0;
+
+        void bindAttributes() const;
+        void unbindAttributes() const;
+};
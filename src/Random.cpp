@@ -0,0 +1,26 @@
+#include "Random.hpp"
+
+Random::Random(uint64_t seed) {
+    // xorshift gets stuck on zero.
+    state = seed ? seed : 0x9E3779B97F4A7C15ull;
+}
+
+uint32_t Random::next() {
+    // xorshift64*
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return (uint32_t)((state * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+int Random::range(int min, int max) {
+    if (max <= min)
+        return min;
+
+    uint32_t span = (uint32_t)(max - min) + 1;
+    return min + (int)(next() % span);
+}
+
+float Random::rangeFloat(float min, float max) {
+    return min + (max - min) * ((next() >> 8) * (1.0f / 16777216));
+}
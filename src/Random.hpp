@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+// Small deterministic random number generator. Unlike GetRandomValue() its whole state is one
+// integer, so it can be saved and restored along with the rest of the world.
+class Random {
+    public:
+        uint64_t state;
+
+        Random(uint64_t seed);
+
+        uint32_t next();
+
+        // Inclusive on both ends, like GetRandomValue().
+        int range(int min, int max);
+
+        // From `min` to `max` in 2^24 even steps, as fine as floats between 0 and 1 get.
+        float rangeFloat(float min, float max);
+};
@@ -0,0 +1,135 @@
+#include "RenderQueue.hpp"
+
+#include "../libs/raylib/src/raymath.h"
+#include "../libs/raylib/src/rlgl.h"
+
+#include "GameCamera.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// Sort key layout, most significant first: pass (4 bits), material (8 bits), depth (32 bits),
+// submission order (20 bits).
+static const int PassShift = 60;
+static const int MaterialShift = 52;
+static const int DepthShift = 20;
+static const uint64_t SequenceMask = (1 << DepthShift) - 1;
+
+const RenderQueue::PipelineState RenderQueue::passStates[] = {
+    { BlendMode::BLEND_ALPHA, true, true, true },       // OPAQUE_PASS
+    { BlendMode::BLEND_ALPHA, true, false, false },     // SKYBOX_PASS
+    { BlendMode::BLEND_ADDITIVE, true, false, true },   // ADDITIVE_PASS
+    { BlendMode::BLEND_ADDITIVE, false, false, true },  // NO_DEPTH_PASS
+    { BlendMode::BLEND_ALPHA, false, true, true },      // UI_PASS, which is how raylib leaves 2D
+};
+
+RenderQueue::RenderQueue(int capacity) {
+    this->capacity = capacity;
+}
+
+void RenderQueue::begin(Vector3 viewPosition, FrameArena& arena) {
+    this->viewPosition = viewPosition;
+    items = FrameList<Item>(arena, capacity);
+    droppedItems = 0;
+}
+
+void RenderQueue::submit(RenderPass pass, RenderMaterial material, Vector3 position,
+                         DrawFunction draw, const void* data) {
+    // Squared distances are positive, so their bit patterns sort the same way the floats do.
+    float distance = Vector3DistanceSqr(viewPosition, position);
+    uint32_t depth;
+    memcpy(&depth, &distance, sizeof(depth));
+
+    // Blended passes are drawn back to front, everything else front to back.
+    if (pass != RenderPass::OPAQUE_PASS)
+        depth = ~depth;
+
+    Item item;
+    item.key = ((uint64_t)pass << PassShift)
+        | ((uint64_t)material << MaterialShift)
+        | ((uint64_t)depth << DepthShift)
+        | ((uint64_t)items.size() & SequenceMask);
+    item.draw = draw;
+    item.data = data;
+
+    if (!items.push(item))
+        droppedItems++;
+}
+
+void RenderQueue::execute(const GameCamera& camera) {
+    stats = Stats();
+    stats.droppedItems = droppedItems;
+
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+        return a.key < b.key;
+    });
+
+    camera.begin3DDrawing();
+    current = passStates[(int)RenderPass::OPAQUE_PASS];
+    bool in3D = true;
+
+    for (auto& item : items) {
+        auto pass = (RenderPass)(item.key >> PassShift);
+
+        if (pass == RenderPass::UI_PASS && in3D) {
+            applyState(passStates[(int)RenderPass::OPAQUE_PASS]);
+            camera.end3DDrawing();
+            current = passStates[(int)RenderPass::UI_PASS];
+            in3D = false;
+        }
+
+        applyState(passStates[(int)pass]);
+        item.draw(item.data);
+        stats.drawCalls++;
+    }
+
+    // Leave things the way raylib expects them.
+    if (in3D) {
+        applyState(passStates[(int)RenderPass::OPAQUE_PASS]);
+        camera.end3DDrawing();
+    } else {
+        applyState(passStates[(int)RenderPass::UI_PASS]);
+    }
+}
+
+void RenderQueue::applyState(const PipelineState& state) {
+    if (state.blendMode == current.blendMode
+        && state.depthTest == current.depthTest
+        && state.depthMask == current.depthMask
+        && state.backfaceCulling == current.backfaceCulling)
+        return;
+
+    // Depth and culling changes don't flush rlgl's batch on their own, so anything still queued
+    // has to go out with the old state first.
+    rlDrawRenderBatchActive();
+    stats.batchFlushes++;
+
+    if (state.blendMode != current.blendMode) {
+        rlSetBlendMode(state.blendMode);
+        stats.stateChanges++;
+    }
+
+    if (state.depthTest != current.depthTest) {
+        if (state.depthTest) rlEnableDepthTest();
+        else rlDisableDepthTest();
+        stats.stateChanges++;
+    }
+
+    if (state.depthMask != current.depthMask) {
+        if (state.depthMask) rlEnableDepthMask();
+        else rlDisableDepthMask();
+        stats.stateChanges++;
+    }
+
+    if (state.backfaceCulling != current.backfaceCulling) {
+        if (state.backfaceCulling) rlEnableBackfaceCulling();
+        else rlDisableBackfaceCulling();
+        stats.stateChanges++;
+    }
+
+    current = state;
+}
+
+const RenderQueue::Stats& RenderQueue::getStats() const {
+    return stats;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "../libs/raylib/src/raylib.h"
+
+#include "FrameArena.hpp"
+
+#include <cstdint>
+
+class GameCamera;
+
+// The pipeline state a draw item needs. Passes are executed in this order.
+enum class RenderPass {
+    OPAQUE_PASS,    // Depth tested and written, back faces culled.
+    SKYBOX_PASS,    // Depth tested but not written, no culling.
+    ADDITIVE_PASS,  // Additive blending, depth tested but not written.
+    NO_DEPTH_PASS,  // Additive blending with no depth test, for overlays placed in the world.
+    UI_PASS         // 2D, drawn after the 3D pass has ended.
+};
+
+// Items that share a material are kept next to each other within a pass.
+enum class RenderMaterial {
+    SHIP,
+    ASTEROID,
+    BULLET,
+    ENEMY_ARROW,
+    SKYBOX,
+    TRAIL,
+    PARTICLES,
+    DUST,
+    CROSSHAIR,
+    HUD
+};
+
+// Collects a frame's draws, then sorts them by pass, material and depth so that pipeline state
+// is only changed (and the rlgl batch only flushed) once per pass instead of once per object.
+class RenderQueue {
+    public:
+        typedef void (*DrawFunction)(const void* data);
+
+        struct Stats {
+            int drawCalls = 0;
+            int stateChanges = 0;
+            int batchFlushes = 0;
+            int droppedItems = 0;
+        };
+
+        // `capacity` is the most items a frame can submit.
+        RenderQueue(int capacity);
+
+        // Starts a new frame, taking the frame's item storage from `arena`. Depth is measured
+        // from `viewPosition`.
+        void begin(Vector3 viewPosition, FrameArena& arena);
+
+        // `data` has to stay alive until execute() returns. Draw functions shouldn't change the
+        // pipeline state themselves, that's what the pass is for. Items past the capacity are
+        // dropped and counted in the stats.
+        void submit(RenderPass pass, RenderMaterial material, Vector3 position,
+                    DrawFunction draw, const void* data);
+
+        // Sorts and draws everything submitted since begin(). 3D passes are drawn with `camera`.
+        void execute(const GameCamera& camera);
+
+        // Counters for the last executed frame. Draw calls are items drawn; immediate mode items
+        // are merged by rlgl and only reach the GPU when the batch is flushed.
+        const Stats& getStats() const;
+
+    private:
+        struct Item {
+            uint64_t key;
+            DrawFunction draw;
+            const void* data;
+        };
+
+        struct PipelineState {
+            int blendMode;
+            bool depthTest;
+            bool depthMask;
+            bool backfaceCulling;
+        };
+
+        static const PipelineState passStates[];
+
+        FrameList<Item> items;
+        int capacity;
+        int droppedItems = 0;
+        Vector3 viewPosition = { 0, 0, 0 };
+        PipelineState current = {};
+        Stats stats;
+
+        void applyState(const PipelineState& state);
+};
@@ -0,0 +1,269 @@
+#include "Scheduler.hpp"
+
+#include <cmath>
+
+// 8 bits of ticks in the first level, 6 in each after that. Anything further out than 2^26 ticks
+// waits in the last level and gets put back there until it's close enough.
+static const int LevelBits[] = { 8, 6, 6, 6 };
+static const int LevelShift[] = { 0, 8, 14, 20 };
+static const int LevelOffset[] = { 0, 256, 256 + 64, 256 + 128 };
+static const uint32_t MaxDelay = (1u << 26) - 1;
+
+Scheduler::Scheduler(int capacity, float tickLength) : nodes(capacity) {
+    this->tickLength = tickLength;
+
+    for (int i = 0; i < slotCount; ++i) {
+        heads[i] = -1;
+        tails[i] = -1;
+    }
+
+    // Build the free list so that low indices get used first.
+    for (int i = capacity - 1; i >= 0; --i) {
+        nodes[i].generation = 1;
+        nodes[i].pending = false;
+        nodes[i].next = freeList;
+        freeList = i;
+    }
+}
+
+uint32_t Scheduler::toTicks(float seconds) const {
+    float ticks = roundf(seconds / tickLength);
+    if (ticks < 1)
+        return 1;
+    if (ticks > MaxDelay)
+        return MaxDelay;
+    return (uint32_t)ticks;
+}
+
+TimerHandle Scheduler::schedule(float delay, Callback callback, void* data) {
+    return add(toTicks(delay), 0, callback, data);
+}
+
+TimerHandle Scheduler::schedulePeriodic(float delay, float period, Callback callback, void* data) {
+    return add(toTicks(delay), toTicks(period), callback, data);
+}
+
+TimerHandle Scheduler::add(uint32_t delay, uint32_t period, Callback callback, void* data) {
+    TimerHandle handle;
+    if (freeList < 0)
+        return handle;
+
+    int32_t index = freeList;
+    Node& node = nodes[index];
+    freeList = node.next;
+
+    node.expiry = currentTick + delay;
+    node.period = period;
+    node.callback = callback;
+    node.data = data;
+    node.pending = true;
+    pendingCount++;
+    insert(index);
+
+    handle.index = index;
+    handle.generation = node.generation;
+    return handle;
+}
+
+bool Scheduler::cancel(TimerHandle handle) {
+    if (!isPending(handle))
+        return false;
+
+    unlink(handle.index);
+    release(handle.index);
+    return true;
+}
+
+bool Scheduler::isPending(TimerHandle handle) const {
+    return handle.isValid()
+        && handle.index < nodes.size()
+        && nodes[handle.index].pending
+        && nodes[handle.index].generation == handle.generation;
+}
+
+void Scheduler::release(int32_t index) {
+    Node& node = nodes[index];
+    node.pending = false;
+    node.generation++;
+    if (node.generation == 0)
+        node.generation = 1;
+
+    node.next = freeList;
+    freeList = index;
+    pendingCount--;
+}
+
+void Scheduler::insert(int32_t index) {
+    Node& node = nodes[index];
+    uint32_t delay = node.expiry - currentTick;
+    uint32_t expiry = delay > MaxDelay ? currentTick + MaxDelay : node.expiry;
+
+    // Pick the lowest level whose range still covers the delay.
+    int level = 0;
+    while (level < levelCount - 1 && delay >= (1u << (LevelShift[level] + LevelBits[level])))
+        level++;
+
+    int32_t slot = LevelOffset[level] + ((expiry >> LevelShift[level]) & ((1u << LevelBits[level]) - 1));
+
+    // Append so timers due on the same tick fire in the order they were scheduled.
+    node.slot = slot;
+    node.next = -1;
+    node.prev = tails[slot];
+    if (tails[slot] >= 0) {
+        nodes[tails[slot]].next = index;
+    } else {
+        heads[slot] = index;
+    }
+    tails[slot] = index;
+}
+
+void Scheduler::unlink(int32_t index) {
+    Node& node = nodes[index];
+    if (node.prev >= 0) {
+        nodes[node.prev].next = node.next;
+    } else {
+        heads[node.slot] = node.next;
+    }
+
+    if (node.next >= 0) {
+        nodes[node.next].prev = node.prev;
+    } else {
+        tails[node.slot] = node.prev;
+    }
+}
+
+void Scheduler::cascade(int level) {
+    int32_t slot = LevelOffset[level] + ((currentTick >> LevelShift[level]) & ((1u << LevelBits[level]) - 1));
+
+    // Everything in the slot is now close enough to move down at least one level.
+    int32_t index = heads[slot];
+    heads[slot] = -1;
+    tails[slot] = -1;
+
+    while (index >= 0) {
+        int32_t next = nodes[index].next;
+        insert(index);
+        index = next;
+    }
+}
+
+void Scheduler::step() {
+    currentTick++;
+
+    for (int level = levelCount - 1; level > 0; --level) {
+        if ((currentTick & ((1u << LevelShift[level]) - 1)) == 0)
+            cascade(level);
+    }
+
+    int32_t slot = currentTick & 255;
+    while (heads[slot] >= 0) {
+        int32_t index = heads[slot];
+        unlink(index);
+
+        Node& node = nodes[index];
+        Callback callback = node.callback;
+        void* data = node.data;
+
+        // Reschedule (or free) before the callback runs so it can cancel or reuse the timer.
+        if (node.period > 0) {
+            node.expiry += node.period;
+            insert(index);
+        } else {
+            release(index);
+        }
+
+        callback(data);
+    }
+}
+
+void Scheduler::advance(float deltaTime) {
+    accumulator += deltaTime;
+    while (accumulator >= tickLength) {
+        accumulator -= tickLength;
+        step();
+    }
+}
+
+uint32_t Scheduler::getTick() const {
+    return currentTick;
+}
+
+int Scheduler::getPendingCount() const {
+    return pendingCount;
+}
+
+void Scheduler::saveState(StateWriter& writer) const {
+    writer.write(currentTick);
+    writer.write(accumulator);
+    writer.write(pendingCount);
+
+    // Saved slot by slot so that reloaded timers keep their firing order.
+    for (int slot = 0; slot < slotCount; ++slot) {
+        for (int32_t index = heads[slot]; index >= 0; index = nodes[index].next) {
+            const Node& node = nodes[index];
+            writer.write(index);
+            writer.write(node.generation);
+            writer.write(node.expiry);
+            writer.write(node.period);
+            writer.write(node.callback);
+            writer.write(node.data);
+        }
+    }
+}
+
+void Scheduler::loadState(StateReader& reader) {
+    reader.read(currentTick);
+    reader.read(accumulator);
+
+    int count = 0;
+    reader.read(count);
+
+    // Invalidate every outstanding handle, then bring back the saved timers in their old slots
+    // so handles from the saved state work again.
+    for (auto& node : nodes) {
+        if (node.pending) {
+            node.pending = false;
+            node.generation++;
+            if (node.generation == 0)
+                node.generation = 1;
+        }
+    }
+
+    for (int i = 0; i < slotCount; ++i) {
+        heads[i] = -1;
+        tails[i] = -1;
+    }
+
+    pendingCount = 0;
+    for (int i = 0; i < count; ++i) {
+        int32_t index = -1;
+        Node loaded = {};
+        reader.read(index);
+        reader.read(loaded.generation);
+        reader.read(loaded.expiry);
+        reader.read(loaded.period);
+        reader.read(loaded.callback);
+        reader.read(loaded.data);
+
+        if (reader.hasOverflowed() || index < 0 || index >= (int32_t)nodes.size())
+            break;
+
+        Node& node = nodes[index];
+        node.generation = loaded.generation;
+        node.expiry = loaded.expiry;
+        node.period = loaded.period;
+        node.callback = loaded.callback;
+        node.data = loaded.data;
+        node.pending = true;
+        pendingCount++;
+        insert(index);
+    }
+
+    freeList = -1;
+    for (int32_t i = (int32_t)nodes.size() - 1; i >= 0; --i) {
+        if (!nodes[i].pending) {
+            nodes[i].next = freeList;
+            freeList = i;
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "State.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Refers to a scheduled timer. Handles to timers that have fired or been cancelled go stale
+// instead of pointing at whatever timer reuses the slot.
+struct TimerHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0;
+
+    bool isValid() const { return generation != 0; }
+};
+
+// Hierarchical timing wheel. Scheduling and cancelling are O(1), and advancing only looks at the
+// timers that are due plus an occasional cascade, so thousands of pending timers cost next to
+// nothing per frame. Time is counted in fixed ticks, and periodic timers are rescheduled from
+// their own deadline so they never drift.
+class Scheduler {
+    public:
+        typedef void (*Callback)(void* data);
+
+        // `capacity` timers can be pending at once. Nothing is allocated after construction.
+        Scheduler(int capacity, float tickLength);
+
+        // Delays are rounded to whole ticks, and are at least one tick. Returns an invalid handle
+        // if every timer is in use.
+        TimerHandle schedule(float delay, Callback callback, void* data);
+        TimerHandle schedulePeriodic(float delay, float period, Callback callback, void* data);
+
+        // Returns false if the timer had already fired or been cancelled.
+        bool cancel(TimerHandle handle);
+        bool isPending(TimerHandle handle) const;
+
+        // Runs the callbacks of every timer that comes due, in the order they're due. Callbacks
+        // may schedule and cancel timers, including their own.
+        void advance(float deltaTime);
+
+        uint32_t getTick() const;
+        int getPendingCount() const;
+
+        // Callbacks and their data are saved as plain pointers, so state can only be loaded back
+        // into the same running program.
+        void saveState(StateWriter& writer) const;
+        void loadState(StateReader& reader);
+
+    private:
+        // Level 0 has a slot per tick. Each slot of the levels above covers a whole turn of the
+        // level below it.
+        static const int levelCount = 4;
+        static const int slotCount = 256 + 64 * 3;
+
+        struct Node {
+            uint32_t expiry;
+            uint32_t period;
+            Callback callback;
+            void* data;
+            uint32_t generation;
+            int32_t prev;
+            int32_t next;
+            int32_t slot;
+            bool pending;
+        };
+
+        std::vector<Node> nodes;
+        int32_t freeList = -1;
+        int pendingCount = 0;
+
+        int32_t heads[slotCount];
+        int32_t tails[slotCount];
+
+        float tickLength;
+        float accumulator = 0;
+        uint32_t currentTick = 0;
+
+        uint32_t toTicks(float seconds) const;
+        TimerHandle add(uint32_t delay, uint32_t period, Callback callback, void* data);
+        void release(int32_t index);
+
+        void insert(int32_t index);
+        void unlink(int32_t index);
+        void cascade(int level);
+        void step();
+};
@@ -3,19 +3,12 @@
 #include "MathUtils.hpp"
 
 #include <vector>
-#include "../libs/raylib/src/rlgl.h"
 
 static const float RungDistance = 2.0f;
 static const float RungTimeToLive = 2.0f;
 
 TrailRung::TrailRung() {}
 
-TrailRung::TrailRung(const TrailRung &oldTrailRung) {
-    this->leftPoint = oldTrailRung.leftPoint;
-    this->rightPoint = oldTrailRung.rightPoint;
-    this->timeToLive = oldTrailRung.timeToLive;
-}
-
 Ship::Ship(Model model, bool isEnemy) {
     shipModel = model;
     rotation = QuaternionFromEuler(1, 2, 0);
@@ -28,50 +21,6 @@ Ship::Ship(Model model, bool isEnemy) {
     }
 }
 
-Ship::Ship(const Ship &oldShip) {
-    this->rotation = oldShip.rotation;
-    this->position = oldShip.position;
-    this->velocity = oldShip.velocity;
-    this->inputForward = oldShip.inputForward;
-    this->inputLeft = oldShip.inputLeft;
-    this->inputUp = oldShip.inputUp;
-    this->inputPitchDown = oldShip.inputPitchDown;
-    this->inputRollRight = oldShip.inputRollRight;
-    this->inputYawLeft = oldShip.inputYawLeft;
-
-    this->maxSpeed = oldShip.maxSpeed;
-    this->throttleResponse = oldShip.throttleResponse;
-    this->turnRate = oldShip.turnRate;
-    this->turnResponse = oldShip.turnResponse;
-
-    this->length = oldShip.length;
-    this->width = oldShip.width;
-
-    this->trailColor = oldShip.trailColor;
-    this->isDead = oldShip.isDead;
-    this->isEnemy = oldShip.isEnemy;
-
-    this->shipModel = oldShip.shipModel;
-    this->shipColor = oldShip.shipColor;
-
-    for (int i = 0; i < this->rungCount; i++) {
-        this->rungs[i] = TrailRung(oldShip.rungs[i]);
-    }
-
-    this->smoothForward = oldShip.smoothForward;
-    this->smoothLeft = oldShip.smoothLeft;
-    this->smoothUp = oldShip.smoothUp;
-
-    this->smoothPitchDown = oldShip.smoothPitchDown;
-    this->smoothRollRight = oldShip.smoothRollRight;
-    this->smoothYawLeft = oldShip.smoothYawLeft;
-
-    this->visualBank = oldShip.visualBank;
-
-    this->lastRungPosition = oldShip.lastRungPosition;
-    this->rungIndex = oldShip.rungIndex;
-}
-
 void Ship::update(float deltaTime) {
     // Give the ship some momentum when accelerating.
     smoothForward = smoothDamp(smoothForward, inputForward, throttleResponse, deltaTime);
@@ -82,18 +31,12 @@ void Ship::update(float deltaTime) {
     auto forwardSpeedMultipilier = smoothForward > 0.0f ? 1.0f : 0.33f;
 
     auto targetVelocity = Vector3Zero();
-    targetVelocity = Vector3Add(
-            targetVelocity,
-            Vector3Scale(getForward(), maxSpeed * forwardSpeedMultipilier * smoothForward));
-    targetVelocity = Vector3Add(
-            targetVelocity,
-            Vector3Scale(getUp(), maxSpeed * .5f * smoothUp));
-    targetVelocity = Vector3Add(
-            targetVelocity,
-            Vector3Scale(getLeft(), maxSpeed * .5f * smoothLeft));
+    targetVelocity = addScaled(targetVelocity, getForward(), maxSpeed * forwardSpeedMultipilier * smoothForward);
+    targetVelocity = addScaled(targetVelocity, getUp(), maxSpeed * .5f * smoothUp);
+    targetVelocity = addScaled(targetVelocity, getLeft(), maxSpeed * .5f * smoothLeft);
 
     velocity = smoothDamp(velocity, targetVelocity, 2.5, deltaTime);
-    position = Vector3Add(position, Vector3Scale(velocity, deltaTime));
+    position = addScaled(position, velocity, deltaTime);
 
     // Give the ship some inertia when turning. These are the pilot controlled rotations.
     smoothPitchDown = smoothDamp(smoothPitchDown, inputPitchDown, turnResponse, deltaTime);
@@ -116,17 +59,14 @@ void Ship::update(float deltaTime) {
     }
     */
 
+    // The simulation has caught up with any input that was late latched.
+    latchedTurn = QuaternionIdentity();
+
     // When yawing and strafing, there's some bank added to the model for visual flavor.
     float targetVisualBank = (-30 * DEG2RAD * smoothYawLeft) + (-15 * DEG2RAD * smoothLeft);
     visualBank = smoothDamp(visualBank, targetVisualBank, 10, deltaTime);
-    Quaternion visualRotation = QuaternionMultiply(
-            rotation, QuaternionFromAxisAngle({ 0, 0, 1 }, visualBank));
 
-    // Sync up the raylib representation of the model with the ship's position so that processing
-    // doesn't have to happen at the render stage.
-    auto transform = MatrixTranslate(position.x, position.y, position.z);
-    transform = MatrixMultiply(QuaternionToMatrix(visualRotation), transform);
-    shipModel.transform = transform;
+    syncModelTransform();
 
     // The currently active trail rung is dragged directly behind the ship for a smoother trail.
     positionActiveTrailRung();
@@ -139,6 +79,37 @@ void Ship::update(float deltaTime) {
         rungs[i].timeToLive -= deltaTime;
 }
 
+void Ship::lateLatch(const ShipInput& input, float seconds) {
+    // The same turn update() would make, from the same smoothed state.
+    float pitchDown = smoothDamp(smoothPitchDown, input.pitchDown, turnResponse, seconds);
+    float rollRight = smoothDamp(smoothRollRight, input.rollRight, turnResponse, seconds);
+    float yawLeft = smoothDamp(smoothYawLeft, input.yawLeft, turnResponse, seconds);
+
+    float radians = turnRate * seconds * DEG2RAD;
+    Quaternion turn = QuaternionFromAxisAngle({ 0, 0, 1 }, rollRight * radians);
+    turn = multiplyQuaternions(turn, QuaternionFromAxisAngle({ 1, 0, 0 }, pitchDown * radians));
+    turn = multiplyQuaternions(turn, QuaternionFromAxisAngle({ 0, 1, 0 }, yawLeft * radians));
+    turn = multiplyQuaternions(turn, QuaternionFromAxisAngle({ 0, 0, -1 }, yawLeft * radians * .5f));
+
+    latchedTurn = turn;
+    syncModelTransform();
+}
+
+Quaternion Ship::getViewRotation() const {
+    return multiplyQuaternions(rotation, latchedTurn);
+}
+
+void Ship::syncModelTransform() {
+    Quaternion visualRotation = QuaternionMultiply(
+            getViewRotation(), QuaternionFromAxisAngle({ 0, 0, 1 }, visualBank));
+
+    // Sync up the raylib representation of the model with the ship's position so that processing
+    // doesn't have to happen at the render stage.
+    auto transform = MatrixTranslate(position.x, position.y, position.z);
+    transform = MatrixMultiply(QuaternionToMatrix(visualRotation), transform);
+    shipModel.transform = transform;
+}
+
 void Ship::positionActiveTrailRung() {
     rungs[rungIndex].timeToLive = RungTimeToLive;
     float halfWidth = width / 2.f;
@@ -147,6 +118,71 @@ void Ship::positionActiveTrailRung() {
     rungs[rungIndex].rightPoint = transformPoint({ halfWidth, 0.0f, -halfLength });
 }
 
+void Ship::saveState(StateWriter& writer) const {
+    writer.write(position);
+    writer.write(velocity);
+    writer.write(rotation);
+
+    writer.write(inputForward);
+    writer.write(inputLeft);
+    writer.write(inputUp);
+    writer.write(inputPitchDown);
+    writer.write(inputRollRight);
+    writer.write(inputYawLeft);
+
+    writer.write(smoothForward);
+    writer.write(smoothLeft);
+    writer.write(smoothUp);
+    writer.write(smoothPitchDown);
+    writer.write(smoothRollRight);
+    writer.write(smoothYawLeft);
+    writer.write(visualBank);
+
+    writer.write(rungs);
+    writer.write(lastRungPosition);
+    writer.write(rungIndex);
+
+    writer.write(trailColor);
+    writer.write(isDead);
+    writer.write(isEnemy);
+    writer.write(id);
+    writer.write(gunState);
+}
+
+void Ship::loadState(StateReader& reader) {
+    reader.read(position);
+    reader.read(velocity);
+    reader.read(rotation);
+
+    reader.read(inputForward);
+    reader.read(inputLeft);
+    reader.read(inputUp);
+    reader.read(inputPitchDown);
+    reader.read(inputRollRight);
+    reader.read(inputYawLeft);
+
+    reader.read(smoothForward);
+    reader.read(smoothLeft);
+    reader.read(smoothUp);
+    reader.read(smoothPitchDown);
+    reader.read(smoothRollRight);
+    reader.read(smoothYawLeft);
+    reader.read(visualBank);
+
+    reader.read(rungs);
+    reader.read(lastRungPosition);
+    reader.read(rungIndex);
+
+    reader.read(trailColor);
+    reader.read(isDead);
+    reader.read(isEnemy);
+    reader.read(id);
+    reader.read(gunState);
+
+    latchedTurn = QuaternionIdentity();
+    syncModelTransform();
+}
+
 void Ship::draw(bool showDebugAxes) const {
     DrawModel(shipModel, Vector3Zero(), 1, shipColor);
 
@@ -158,17 +194,10 @@ void Ship::draw(bool showDebugAxes) const {
         DrawSphereWires(position, 0.3, 5, 5, GRAY);
         EndBlendMode();
     }
-
-    if (this->isEnemy) {
-        this->drawTrail();
-    }
 }
 
-void Ship::drawTrail() const
+void Ship::buildTrail(FrameList<TrailLine>& lines, FrameList<TrailTriangle>& triangles) const
 {
-    BeginBlendMode(BlendMode::BLEND_ADDITIVE);
-    rlDisableDepthMask();
-
     for (int i = 0; i < rungCount; ++i)
     {
         if (rungs[i].timeToLive <= 0)
@@ -184,25 +213,30 @@ void Ship::drawTrail() const
         // The current rung is dragged along behind the ship, so the crossbar shouldn't be drawn.
         // If the crossbar is drawn when the ship is slow, it looks weird having a line behind it.
         if (i != rungIndex)
-            DrawLine3D(thisRung.leftPoint, thisRung.rightPoint, color);
+            lines.push({ thisRung.leftPoint, thisRung.rightPoint, color });
 
         auto& nextRung = rungs[(i + 1) % rungCount];
         if (nextRung.timeToLive > 0 && thisRung.timeToLive < nextRung.timeToLive)
         {
-            DrawLine3D(nextRung.leftPoint, thisRung.leftPoint, color);
-            DrawLine3D(nextRung.rightPoint, thisRung.rightPoint, color);
+            lines.push({ nextRung.leftPoint, thisRung.leftPoint, color });
+            lines.push({ nextRung.rightPoint, thisRung.rightPoint, color });
 
-            DrawTriangle3D(thisRung.leftPoint, thisRung.rightPoint, nextRung.leftPoint, fill);
-            DrawTriangle3D(nextRung.leftPoint, thisRung.rightPoint, nextRung.rightPoint, fill);
+            triangles.push({ thisRung.leftPoint, thisRung.rightPoint, nextRung.leftPoint, fill });
+            triangles.push({ nextRung.leftPoint, thisRung.rightPoint, nextRung.rightPoint, fill });
 
-            DrawTriangle3D(nextRung.leftPoint, thisRung.rightPoint, thisRung.leftPoint, fill);
-            DrawTriangle3D(nextRung.rightPoint, thisRung.rightPoint, nextRung.leftPoint, fill);
+            triangles.push({ nextRung.leftPoint, thisRung.rightPoint, thisRung.leftPoint, fill });
+            triangles.push({ nextRung.rightPoint, thisRung.rightPoint, nextRung.leftPoint, fill });
         }
     }
+}
+
+void drawTrails(const FrameList<TrailLine>& lines, const FrameList<TrailTriangle>& triangles)
+{
+    for (auto& line : lines)
+        DrawLine3D(line.from, line.to, line.color);
 
-    rlDrawRenderBatchActive();
-    rlEnableDepthMask();
-    EndBlendMode();
+    for (auto& triangle : triangles)
+        DrawTriangle3D(triangle.a, triangle.b, triangle.c, triangle.color);
 }
 
 Crosshair::Crosshair(const char* modelPath)
@@ -217,20 +251,18 @@ Crosshair::~Crosshair()
 
 void Crosshair::positionCrosshairOnShip(const Ship& ship, float distance)
 {
-    auto crosshairPos = Vector3Add(Vector3Add(Vector3Scale(ship.getForward(), distance), ship.position), ship.getDown());
+    // Follows the drawn ship, so late latched input moves the crosshair too.
+    Quaternion rotation = ship.getViewRotation();
+    auto forward = rotateVector(rotation, { 0, 0, 1 });
+    auto down = rotateVector(rotation, { 0, -1, 0 });
+    auto crosshairPos = Vector3Add(Vector3Add(Vector3Scale(forward, distance), ship.position), down);
     auto crosshairTransform = MatrixTranslate(crosshairPos.x, crosshairPos.y, crosshairPos.z);
-    crosshairTransform = MatrixMultiply(QuaternionToMatrix(ship.rotation), crosshairTransform);
+    crosshairTransform = MatrixMultiply(QuaternionToMatrix(rotation), crosshairTransform);
     crosshairModel.transform = crosshairTransform;
 }
 
 void Crosshair::drawCrosshair() const
 {
-    BeginBlendMode(BlendMode::BLEND_ADDITIVE);
-    rlDisableDepthTest();
-
     DrawModel(crosshairModel, Vector3Zero(), 1, GREEN);
     //DrawModelWires(CrosshairModel, Vector3Zero(), 1, DARKGREEN);
-
-    rlEnableDepthTest();
-    EndBlendMode();
 }
@@ -1,19 +1,56 @@
 #pragma once
 
 #include "Actor.hpp"
+#include "State.hpp"
+#include "FrameArena.hpp"
 
 #include "../libs/raylib/src/raylib.h"
 
+// What the pilot is asking the ship to do this frame.
+struct ShipInput {
+    float forward = 0;
+    float pitchDown = 0;
+    float rollRight = 0;
+    float yawLeft = 0;
+};
+
+// Where an enemy's gun is between shots.
+enum class GunState : uint8_t {
+    // Waiting on a scheduled event to be ready again.
+    COOLING,
+    READY,
+    // Couldn't be scheduled because every timer was in use. Tried again next tick.
+    UNSCHEDULED
+};
+
 struct TrailRung {
     Vector3 leftPoint;
     Vector3 rightPoint;
     float timeToLive;
     TrailRung();
-    TrailRung(const TrailRung &oldTrailRung);
+};
+
+struct TrailLine {
+    Vector3 from;
+    Vector3 to;
+    Color color;
+};
+
+struct TrailTriangle {
+    Vector3 a;
+    Vector3 b;
+    Vector3 c;
+    Color color;
 };
 
 class Ship : public Actor {
     public:
+        static const int rungCount = 16;
+
+        // Most primitives buildTrail() adds for one ship, for sizing the lists.
+        static const int maxTrailLines = rungCount * 3;
+        static const int maxTrailTriangles = rungCount * 4;
+
         float inputForward = 0;
         float inputLeft = 0;
         float inputUp = 0;
@@ -33,19 +70,38 @@ class Ship : public Actor {
         Color trailColor = DARKGREEN;
         bool isDead = false;
         bool isEnemy = false;
+        // Enemies are found by this, since their place in the world's list shifts as others are
+        // removed. The player's is 0.
+        uint32_t id = 0;
+        // Only enemies use it, the player fires on input.
+        GunState gunState = GunState::UNSCHEDULED;
 
         Ship(Model model, bool isEnemy);
 
         void update(float deltaTime);
+
+        // Turns the drawn ship by as much as `input` would turn it in `seconds`, without touching
+        // the simulation. This lets input sampled after the update still show up this frame. The
+        // next update clears it.
+        void lateLatch(const ShipInput& input, float seconds);
+
+        // The rotation the ship is drawn with. Same as `rotation` unless late latched.
+        Quaternion getViewRotation() const;
         void draw(bool showDebugAxes) const;
-        void drawTrail() const;
-        Ship(const Ship &oldShip);
+
+        // Trails blend and don't write depth, so they're drawn separately from the ship model.
+        // The geometry is built once a frame, then every view draws it with drawTrails().
+        void buildTrail(FrameList<TrailLine>& lines, FrameList<TrailTriangle>& triangles) const;
+
+        // Saves simulation state only. The model isn't touched when loading, apart from its
+        // transform which is rebuilt from the loaded state.
+        void saveState(StateWriter& writer) const;
+        void loadState(StateReader& reader);
 
     private:
         Model shipModel = {};
         Color shipColor = {};
 
-        static const int rungCount = 16;
         TrailRung rungs[rungCount];
 
         float smoothForward = 0;
@@ -57,18 +113,25 @@ class Ship : public Actor {
         float smoothYawLeft = 0;
 
         float visualBank = 0;
+        Quaternion latchedTurn = { 0, 0, 0, 1 };
 
         void positionActiveTrailRung();
+        void syncModelTransform();
         Vector3 lastRungPosition = { 0, 0, 0 };
         int rungIndex = 0;
 };
 
+// Expects RenderPass::ADDITIVE_PASS state.
+void drawTrails(const FrameList<TrailLine>& lines, const FrameList<TrailTriangle>& triangles);
+
 class Crosshair {
     public:
         Crosshair(const char* modelPath);
         ~Crosshair();
 
         void positionCrosshairOnShip(const Ship& ship, float distance);
+
+        // Expects RenderPass::NO_DEPTH_PASS state so the crosshair is never hidden.
         void drawCrosshair() const;
 
     private:
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "../libs/raylib/src/raylib.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// ==================================================================================
+// Small vector math layer for the per-entity hot paths. A Vector3 or Quaternion goes in one SSE
+// register and comes back out, so callers keep using the raylib types. Falls back to plain
+// floats where SSE2 isn't there (including the web build).
+// ==================================================================================
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define HYPERSONIC_SSE 1
+    #include <emmintrin.h>
+#else
+    #define HYPERSONIC_SSE 0
+#endif
+
+#if HYPERSONIC_SSE
+
+typedef __m128 Float4;
+
+inline Float4 loadFloat4(Vector3 v) { return _mm_set_ps(0, v.z, v.y, v.x); }
+inline Float4 loadFloat4(Quaternion q) { return _mm_set_ps(q.w, q.z, q.y, q.x); }
+inline Float4 splatFloat4(float value) { return _mm_set1_ps(value); }
+
+// Four floats from an array, which needn't be aligned.
+inline Float4 loadFloat4(const float* values) { return _mm_loadu_ps(values); }
+inline void storeFloat4(float* values, Float4 f) { _mm_storeu_ps(values, f); }
+
+inline Vector3 storeVector3(Float4 f) {
+    float lanes[4];
+    _mm_storeu_ps(lanes, f);
+    return { lanes[0], lanes[1], lanes[2] };
+}
+
+inline Quaternion storeQuaternion(Float4 f) {
+    Quaternion q;
+    _mm_storeu_ps(&q.x, f);
+    return q;
+}
+
+inline Float4 add4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+inline Float4 sub4(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+inline Float4 mul4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+inline Float4 sqrt4(Float4 f) { return _mm_sqrt_ps(f); }
+
+#define HYPERSONIC_SHUFFLE(v, x, y, z, w) _mm_shuffle_ps((v), (v), _MM_SHUFFLE(w, z, y, x))
+
+// Only the first three lanes mean anything. The last comes out as zero.
+inline Float4 cross4(Float4 a, Float4 b) {
+    Float4 ayzx = HYPERSONIC_SHUFFLE(a, 1, 2, 0, 3);
+    Float4 bzxy = HYPERSONIC_SHUFFLE(b, 2, 0, 1, 3);
+    Float4 azxy = HYPERSONIC_SHUFFLE(a, 2, 0, 1, 3);
+    Float4 byzx = HYPERSONIC_SHUFFLE(b, 1, 2, 0, 3);
+    return _mm_sub_ps(_mm_mul_ps(ayzx, bzxy), _mm_mul_ps(azxy, byzx));
+}
+
+inline Float4 quaternionMultiply4(Float4 a, Float4 b) {
+    const Float4 flipW = _mm_set_ps(-0.0f, 0, 0, 0);
+
+    Float4 result = _mm_mul_ps(a, HYPERSONIC_SHUFFLE(b, 3, 3, 3, 3));
+    result = _mm_add_ps(result, _mm_xor_ps(flipW,
+            _mm_mul_ps(HYPERSONIC_SHUFFLE(a, 3, 3, 3, 0), HYPERSONIC_SHUFFLE(b, 0, 1, 2, 0))));
+    result = _mm_add_ps(result, _mm_xor_ps(flipW,
+            _mm_mul_ps(HYPERSONIC_SHUFFLE(a, 1, 2, 0, 1), HYPERSONIC_SHUFFLE(b, 2, 0, 1, 1))));
+    return _mm_sub_ps(result,
+            _mm_mul_ps(HYPERSONIC_SHUFFLE(a, 2, 0, 1, 2), HYPERSONIC_SHUFFLE(b, 1, 2, 0, 2)));
+}
+
+// v + 2w(u x v) + 2u x (u x v), where u is the vector part of q. No matrix needed.
+inline Float4 rotate4(Float4 q, Float4 v) {
+    Float4 t = cross4(q, v);
+    t = _mm_add_ps(t, t);
+    Float4 w = HYPERSONIC_SHUFFLE(q, 3, 3, 3, 3);
+    return _mm_add_ps(v, _mm_add_ps(_mm_mul_ps(w, t), cross4(q, t)));
+}
+
+#undef HYPERSONIC_SHUFFLE
+
+#else
+
+struct Float4 {
+    float x, y, z, w;
+};
+
+inline Float4 loadFloat4(Vector3 v) { return { v.x, v.y, v.z, 0 }; }
+inline Float4 loadFloat4(Quaternion q) { return { q.x, q.y, q.z, q.w }; }
+inline Float4 splatFloat4(float value) { return { value, value, value, value }; }
+inline Float4 loadFloat4(const float* values) { return { values[0], values[1], values[2], values[3] }; }
+inline void storeFloat4(float* values, Float4 f) { values[0] = f.x; values[1] = f.y; values[2] = f.z; values[3] = f.w; }
+inline Vector3 storeVector3(Float4 f) { return { f.x, f.y, f.z }; }
+inline Quaternion storeQuaternion(Float4 f) { return { f.x, f.y, f.z, f.w }; }
+
+inline Float4 add4(Float4 a, Float4 b) { return { a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w }; }
+inline Float4 sub4(Float4 a, Float4 b) { return { a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w }; }
+inline Float4 mul4(Float4 a, Float4 b) { return { a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w }; }
+inline Float4 sqrt4(Float4 f) { return { sqrtf(f.x), sqrtf(f.y), sqrtf(f.z), sqrtf(f.w) }; }
+
+inline Float4 cross4(Float4 a, Float4 b) {
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x, 0 };
+}
+
+inline Float4 quaternionMultiply4(Float4 a, Float4 b) {
+    return {
+        a.x * b.w + a.w * b.x + a.y * b.z - a.z * b.y,
+        a.y * b.w + a.w * b.y + a.z * b.x - a.x * b.z,
+        a.z * b.w + a.w * b.z + a.x * b.y - a.y * b.x,
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+    };
+}
+
+inline Float4 rotate4(Float4 q, Float4 v) {
+    Float4 t = cross4(q, v);
+    t = add4(t, t);
+    return add4(v, add4(mul4(splatFloat4(q.w), t), cross4(q, t)));
+}
+
+#endif
+
+// a + (b - a) * t
+inline Float4 lerp4(Float4 a, Float4 b, float t) {
+    return add4(a, mul4(sub4(b, a), splatFloat4(t)));
+}
+
+// ==================================================================================
+// raylib typed wrappers
+// ==================================================================================
+
+// Same as Vector3RotateByQuaternion() for unit quaternions, without the matrix-like expansion.
+inline Vector3 rotateVector(Quaternion q, Vector3 v) {
+    return storeVector3(rotate4(loadFloat4(q), loadFloat4(v)));
+}
+
+// Same as QuaternionMultiply(): rotates by `b`, then by `a`.
+inline Quaternion multiplyQuaternions(Quaternion a, Quaternion b) {
+    return storeQuaternion(quaternionMultiply4(loadFloat4(a), loadFloat4(b)));
+}
+
+inline Vector3 lerpVector3(Vector3 a, Vector3 b, float t) {
+    return storeVector3(lerp4(loadFloat4(a), loadFloat4(b), t));
+}
+
+// a + b * scale
+inline Vector3 addScaled(Vector3 a, Vector3 b, float scale) {
+    return storeVector3(add4(loadFloat4(a), mul4(loadFloat4(b), splatFloat4(scale))));
+}
+
+// e^x with a relative error under 2e-5 for x in [-87, 88]. Inputs outside that range are
+// clamped. Cheaper than expf: the whole part of the power of two goes straight into the float's
+// exponent bits and the rest comes from a polynomial. fastExp(0) is exactly 1, so damping factors
+// like 1 - fastExp(-speed * dt) are exactly 0 for no time and stay accurate for tiny steps.
+inline float fastExp(float x) {
+    x = x < -87.0f ? -87.0f : (x > 88.0f ? 88.0f : x);
+
+    // e^x = 2^n 2^f, with n the nearest whole number to x / ln2 and |f| <= 0.5. Adding 1.5 * 2^23
+    // rounds to a whole number, which ends up in the low bits of the sum.
+    float y = x * 1.44269504f;
+    float shifted = y + 12582912.0f;
+    float f = y - (shifted - 12582912.0f);
+    int32_t whole;
+    memcpy(&whole, &shifted, sizeof(whole));
+    whole -= 0x4B400000;
+
+    // 2^f = 1 + f q(f), with q a minimax fit of (2^f - 1) / f over [-0.5, 0.5] that's off by at
+    // most 1.5e-5. Keeping the 1 exact is what makes small steps come out right.
+    float q = 0.00961808351f;
+    q = q * f + 0.0558371100f;
+    q = q * f + 0.240232519f;
+    q = q * f + 0.693136869f;
+    float p = 1 + f * q;
+
+    // Multiply by 2^n by building its float directly.
+    int32_t bits = (whole + 127) << 23;
+    float scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
@@ -0,0 +1,45 @@
+#include "Skybox.hpp"
+
+Skybox::Skybox(const char* texturePath, int glslVersion) {
+    skyboxModel = LoadModelFromMesh(GenMeshCube(1.0f, 1.0f, 1.0f));
+
+    skyboxShader = LoadShader(TextFormat("assets/shaders/glsl%i/skybox.vs", glslVersion),
+                              TextFormat("assets/shaders/glsl%i/skybox.fs", glslVersion));
+
+    int environmentMap = MATERIAL_MAP_CUBEMAP;
+    int off = 0;
+    SetShaderValue(skyboxShader, GetShaderLocation(skyboxShader, "environmentMap"), &environmentMap, SHADER_UNIFORM_INT);
+    SetShaderValue(skyboxShader, GetShaderLocation(skyboxShader, "doGamma"), &off, SHADER_UNIFORM_INT);
+    SetShaderValue(skyboxShader, GetShaderLocation(skyboxShader, "vflipped"), &off, SHADER_UNIFORM_INT);
+    skyboxModel.materials[0].shader = skyboxShader;
+
+    // Repeat the background on every face of a horizontal strip, which raylib can load directly
+    // as a cubemap.
+    Image face = LoadImage(texturePath);
+    ImageFormat(&face, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    Image strip = GenImageColor(face.width * 6, face.height, BLACK);
+    Rectangle faceRect = { 0, 0, (float)face.width, (float)face.height };
+    for (int i = 0; i < 6; ++i) {
+        ImageDraw(&strip, face, faceRect,
+                  { (float)(face.width * i), 0, (float)face.width, (float)face.height },
+                  WHITE);
+    }
+
+    cubemap = LoadTextureCubemap(strip, CUBEMAP_LAYOUT_LINE_HORIZONTAL);
+    skyboxModel.materials[0].maps[MATERIAL_MAP_CUBEMAP].texture = cubemap;
+
+    UnloadImage(strip);
+    UnloadImage(face);
+}
+
+Skybox::~Skybox() {
+    UnloadTexture(cubemap);
+    UnloadShader(skyboxShader);
+    UnloadModel(skyboxModel);
+}
+
+void Skybox::draw() const {
+    // The vertex shader ignores the camera's position, so the cube is always centered on it.
+    DrawModel(skyboxModel, { 0, 0, 0 }, 1.0f, WHITE);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../libs/raylib/src/raylib.h"
+
+class Skybox {
+    public:
+        // Bakes the image at `texturePath` onto all six faces of a cubemap. This only happens once,
+        // at load, so there's no per-frame cost for using a flat background image.
+        Skybox(const char* texturePath, int glslVersion);
+        ~Skybox();
+
+        // The skybox is always drawn at the far plane. It should be drawn after opaque geometry so
+        // that the depth test rejects covered pixels before they're shaded, but before anything that
+        // doesn't write depth (trails, dust), otherwise it would draw over those. That's exactly
+        // where RenderPass::SKYBOX_PASS puts it, and that pass also sets up the state it needs.
+        void draw() const;
+
+    private:
+        Model skyboxModel = {};
+        Shader skyboxShader = {};
+        TextureCubemap cubemap = {};
+};
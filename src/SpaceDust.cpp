@@ -1,7 +1,6 @@
 #include "SpaceDust.hpp"
 
 #include "../libs/raylib/src/raymath.h"
-#include "../libs/raylib/src/rlgl.h"
 #include <cmath>
 #include <array>
 
@@ -35,31 +34,21 @@ SpaceDust::SpaceDust(float size, int count) {
     }
 }
 
-void SpaceDust::updateViewPosition(Vector3 viewPosition) {
-    float size = extent * 2;
-    for (auto& p : points) {
-        while (p.x > viewPosition.x + extent)
-            p.x -= size;
-        while (p.x < viewPosition.x - extent)
-            p.x += size;
-
-        while (p.y > viewPosition.y + extent)
-            p.y -= size;
-        while (p.y < viewPosition.y - extent)
-            p.y += size;
-
-        while (p.z > viewPosition.z + extent)
-            p.z -= size;
-        while (p.z < viewPosition.z - extent)
-            p.z += size;
-    }
+// Where `value` wraps to in the `size` wide span centered on `center`.
+static float wrap(float value, float center, float size) {
+    float offset = value - center;
+    return center + offset - size * floorf(offset / size + 0.5f);
 }
 
 void SpaceDust::draw(Vector3 viewPosition, Vector3 velocity, bool drawDots) const {
-    BeginBlendMode(BlendMode::BLEND_ADDITIVE);
-
+    float size = extent * 2;
     for (int i = 0; i < points.size(); ++i) {
-        float distance = Vector3Distance(viewPosition, points[i]);
+        Vector3 point = {
+            wrap(points[i].x, viewPosition.x, size),
+            wrap(points[i].y, viewPosition.y, size),
+            wrap(points[i].z, viewPosition.z, size)
+        };
+        float distance = Vector3Distance(viewPosition, point);
 
         float farLerp = Clamp(Normalize(distance, extent * .9f, extent), 0, 1);
         unsigned char farAlpha = (unsigned char)Lerp(255, 0, farLerp);
@@ -67,17 +56,14 @@ void SpaceDust::draw(Vector3 viewPosition, Vector3 velocity, bool drawDots) cons
         const float cubeSize = 0.01f;
 
         if (drawDots) {
-            DrawSphereWires(points[i],
+            DrawSphereWires(point,
                             cubeSize,
                             2, 4,
                             { colors[i].r, colors[i].g, colors[i].b, farAlpha });
         }
 
-        DrawLine3D(Vector3Add(points[i], Vector3Scale(velocity, 0.02f)),
-                   points[i],
+        DrawLine3D(Vector3Add(point, Vector3Scale(velocity, 0.02f)),
+                   point,
                   { colors[i].r, colors[i].g, colors[i].b, farAlpha });
     }
-
-    rlDrawRenderBatchActive();
-    EndBlendMode();
 }
@@ -8,7 +8,9 @@ class SpaceDust {
     public:
         SpaceDust(float size, int count);
 
-        void updateViewPosition(Vector3 viewPosition);
+        // The dust fills a cube around `viewPosition`, wrapping around as the view moves. The
+        // points are never moved, so any number of views can draw the same dust.
+        // Expects RenderPass::ADDITIVE_PASS state.
         void draw(Vector3 viewPosition, Vector3 velocity, bool drawDots) const;
 
     private:
@@ -0,0 +1,61 @@
+#include "State.hpp"
+
+StateWriter::StateWriter(uint8_t* buffer, int capacity) {
+    this->buffer = buffer;
+    this->capacity = capacity;
+}
+
+void StateWriter::writeBytes(const void* data, int size) {
+    if (overflowed || this->size + size > capacity) {
+        overflowed = true;
+        return;
+    }
+
+    memcpy(buffer + this->size, data, size);
+    this->size += size;
+}
+
+int StateWriter::getSize() const {
+    return size;
+}
+
+bool StateWriter::hasOverflowed() const {
+    return overflowed;
+}
+
+StateReader::StateReader(const uint8_t* buffer, int size) {
+    this->buffer = buffer;
+    this->size = size;
+}
+
+void StateReader::readBytes(void* data, int size) {
+    if (overflowed || position + size > this->size) {
+        overflowed = true;
+        return;
+    }
+
+    memcpy(data, buffer + position, size);
+    position += size;
+}
+
+bool StateReader::hasOverflowed() const {
+    return overflowed;
+}
+
+StateHistory::StateHistory(int slotCount, int slotSize) : slots(slotCount), memory((size_t)slotCount * slotSize) {
+    this->slotSize = slotSize;
+}
+
+bool StateHistory::contains(uint32_t tick) const {
+    const Slot& slot = slots[tick % slots.size()];
+    return slot.valid && slot.tick == tick;
+}
+
+int StateHistory::getSize(uint32_t tick) const {
+    return contains(tick) ? slots[tick % slots.size()].size : 0;
+}
+
+void StateHistory::clear() {
+    for (auto& slot : slots)
+        slot = Slot();
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Writes simulation state as raw bytes into a caller owned buffer. Only plain values go in here,
+// never render resources like models or textures.
+class StateWriter {
+    public:
+        StateWriter(uint8_t* buffer, int capacity);
+
+        template <typename T>
+        void write(const T& value) {
+            static_assert(std::is_trivially_copyable<T>::value, "State must be plain data");
+            writeBytes(&value, sizeof(T));
+        }
+
+        void writeBytes(const void* data, int size);
+
+        int getSize() const;
+        bool hasOverflowed() const;
+
+    private:
+        uint8_t* buffer;
+        int capacity;
+        int size = 0;
+        bool overflowed = false;
+};
+
+class StateReader {
+    public:
+        StateReader(const uint8_t* buffer, int size);
+
+        template <typename T>
+        void read(T& value) {
+            static_assert(std::is_trivially_copyable<T>::value, "State must be plain data");
+            readBytes(&value, sizeof(T));
+        }
+
+        // Reading past the end leaves the destination untouched and sets this.
+        void readBytes(void* data, int size);
+        bool hasOverflowed() const;
+
+    private:
+        const uint8_t* buffer;
+        int size;
+        int position = 0;
+        bool overflowed = false;
+};
+
+// Keeps the state of the last `slotCount` ticks in one block of memory allocated up front, so
+// saving every tick never allocates. Anything with saveState(StateWriter&) const and
+// loadState(StateReader&) can be stored.
+class StateHistory {
+    public:
+        StateHistory(int slotCount, int slotSize);
+
+        // Returns false if the state didn't fit in a slot.
+        template <typename T>
+        bool save(uint32_t tick, const T& object) {
+            Slot& slot = slots[tick % slots.size()];
+            StateWriter writer(&memory[(tick % slots.size()) * slotSize], slotSize);
+            object.saveState(writer);
+
+            slot.valid = !writer.hasOverflowed();
+            slot.tick = tick;
+            slot.size = writer.getSize();
+            return slot.valid;
+        }
+
+        // Returns false if `tick` was never saved or has since been overwritten.
+        template <typename T>
+        bool restore(uint32_t tick, T& object) const {
+            if (!contains(tick))
+                return false;
+
+            const Slot& slot = slots[tick % slots.size()];
+            StateReader reader(&memory[(tick % slots.size()) * slotSize], slot.size);
+            object.loadState(reader);
+            return !reader.hasOverflowed();
+        }
+
+        bool contains(uint32_t tick) const;
+
+        // Size in bytes of the state saved for `tick`, or 0.
+        int getSize(uint32_t tick) const;
+
+        void clear();
+
+    private:
+        struct Slot {
+            uint32_t tick = 0;
+            int size = 0;
+            bool valid = false;
+        };
+
+        std::vector<Slot> slots;
+        std::vector<uint8_t> memory;
+        int slotSize;
+};
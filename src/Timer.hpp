@@ -1,10 +0,0 @@
-#pragma once
-
-class Timer {
-    public:
-        Timer(float delay, bool repeat);
-        float delay;
-        float timeElapsed;
-        bool repeat;
-        bool update(float deltaTime);
-};
@@ -0,0 +1,160 @@
+#include "UILayer.hpp"
+
+#include "../libs/raylib/src/rlgl.h"
+#include <cstring>
+#include <cstdio>
+
+// GL blend factors for premultiplied alpha. The cached texture stores premultiplied colors so that
+// alpha blended and additive widgets can share one texture and still composite in a single quad.
+static const int GlOne = 1;
+static const int GlOneMinusSrcAlpha = 0x0303;
+static const int GlFuncAdd = 0x8006;
+
+static Color premultiply(Color color, bool additive) {
+    float alpha = color.a / 255.0f;
+    return Color{
+        (unsigned char)(color.r * alpha),
+        (unsigned char)(color.g * alpha),
+        (unsigned char)(color.b * alpha),
+        // Additive widgets don't occlude anything behind them.
+        additive ? (unsigned char)0 : color.a
+    };
+}
+
+static void beginPremultipliedBlending() {
+    rlSetBlendFactors(GlOne, GlOneMinusSrcAlpha, GlFuncAdd);
+    BeginBlendMode(BlendMode::BLEND_CUSTOM);
+}
+
+UILayer::UILayer(int width, int height) {
+    this->width = width;
+    this->height = height;
+    target = LoadRenderTexture(width, height);
+    SetTextureFilter(target.texture, TextureFilter::TEXTURE_FILTER_POINT);
+}
+
+UILayer::~UILayer() {
+    UnloadRenderTexture(target);
+}
+
+int UILayer::addLabel(const char* text, Vector2 anchor, Vector2 pivot, int fontSize, Color color) {
+    Widget widget = {};
+    widget.anchor = anchor;
+    widget.pivot = pivot;
+    widget.fontSize = fontSize;
+    widget.color = color;
+    widget.visible = true;
+    strncpy(widget.text, text, maxTextLength - 1);
+    layout(widget);
+
+    widgets.push_back(widget);
+    dirty = true;
+    return (int)widgets.size() - 1;
+}
+
+void UILayer::setPanel(int widget, Rectangle bounds, Color fill, Color outline, float outlineThickness) {
+    auto& w = widgets[widget];
+    w.hasPanel = true;
+    w.panel = bounds;
+    w.panelFill = fill;
+    w.panelOutline = outline;
+    w.panelOutlineThickness = outlineThickness;
+    dirty = true;
+}
+
+void UILayer::setAdditive(int widget, bool additive) {
+    if (widgets[widget].additive != additive) {
+        widgets[widget].additive = additive;
+        dirty = true;
+    }
+}
+
+void UILayer::setText(int widget, const char* text) {
+    auto& w = widgets[widget];
+    if (strncmp(w.text, text, maxTextLength - 1) == 0)
+        return;
+
+    strncpy(w.text, text, maxTextLength - 1);
+    layout(w);
+    dirty = true;
+}
+
+void UILayer::setValue(int widget, const char* format, int value) {
+    auto& w = widgets[widget];
+    if (w.hasValue && w.value == value)
+        return;
+
+    w.hasValue = true;
+    w.value = value;
+    snprintf(w.text, maxTextLength, format, value);
+    layout(w);
+    dirty = true;
+}
+
+void UILayer::setVisible(int widget, bool visible) {
+    if (widgets[widget].visible != visible) {
+        widgets[widget].visible = visible;
+        dirty = true;
+    }
+}
+
+void UILayer::layout(Widget& widget) {
+    // Same spacing rule as DrawText() so the measurement matches what gets drawn.
+    float spacing = (float)(widget.fontSize / 10);
+    Vector2 size = MeasureTextEx(GetFontDefault(), widget.text, (float)widget.fontSize, spacing);
+    widget.textPosition = Vector2{
+        widget.anchor.x - (size.x * widget.pivot.x),
+        widget.anchor.y - (size.y * widget.pivot.y)
+    };
+}
+
+void UILayer::refresh() {
+    if (!dirty)
+        return;
+
+    BeginTextureMode(target);
+    ClearBackground(BLANK);
+
+    for (auto& widget : widgets) {
+        if (widget.visible)
+            drawWidget(widget);
+    }
+
+    EndTextureMode();
+    dirty = false;
+}
+
+void UILayer::drawWidget(const Widget& widget) const {
+    if (widget.additive) {
+        BeginBlendMode(BlendMode::BLEND_ADD_COLORS);
+    } else {
+        beginPremultipliedBlending();
+    }
+
+    if (widget.hasPanel) {
+        DrawRectangleRec(widget.panel, premultiply(widget.panelFill, widget.additive));
+        DrawRectangleLinesEx(widget.panel,
+                             widget.panelOutlineThickness,
+                             premultiply(widget.panelOutline, widget.additive));
+    }
+
+    DrawText(widget.text,
+             (int)widget.textPosition.x,
+             (int)widget.textPosition.y,
+             widget.fontSize,
+             premultiply(widget.color, widget.additive));
+
+    EndBlendMode();
+}
+
+void UILayer::draw() const {
+    beginPremultipliedBlending();
+
+    // Render texture height is flipped due to OpenGL reasons.
+    DrawTextureRec(target.texture,
+                   { 0, 0, (float)width, -(float)height },
+                   { 0, 0 },
+                   WHITE);
+
+    EndBlendMode();
+}
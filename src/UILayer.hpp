@@ -0,0 +1,70 @@
+#pragma once
+
+#include "../libs/raylib/src/raylib.h"
+
+#include <vector>
+
+// A retained HUD layer. Widgets are laid out and rasterized into the layer's own render texture
+// only when their content changes, and the whole layer is composited with a single textured quad.
+class UILayer {
+    public:
+        UILayer(int width, int height);
+        ~UILayer();
+
+        // Adds a text widget and returns its id. The text is placed so that `pivot` (a fraction
+        // of the measured text size) lands on `anchor`, which makes centering trivial.
+        int addLabel(const char* text, Vector2 anchor, Vector2 pivot, int fontSize, Color color);
+
+        // Gives a widget a filled, outlined panel that is drawn underneath its text.
+        void setPanel(int widget, Rectangle bounds, Color fill, Color outline, float outlineThickness);
+
+        // Additive widgets brighten whatever is behind them instead of covering it.
+        void setAdditive(int widget, bool additive);
+
+        void setText(int widget, const char* text);
+
+        // Formats `value` into the widget's text, but only when it differs from the last value.
+        void setValue(int widget, const char* format, int value);
+
+        void setVisible(int widget, bool visible);
+
+        // Re-renders the cached texture if any widget changed. raylib can't nest texture modes,
+        // so this has to be called before the frame's render target is bound.
+        void refresh();
+
+        // Composites the cached texture on top of whatever is currently being drawn.
+        void draw() const;
+
+    private:
+        static const int maxTextLength = 64;
+
+        struct Widget {
+            char text[maxTextLength];
+            Vector2 anchor;
+            Vector2 pivot;
+            Vector2 textPosition;
+            int fontSize;
+            Color color;
+
+            bool hasPanel;
+            Rectangle panel;
+            Color panelFill;
+            Color panelOutline;
+            float panelOutlineThickness;
+
+            bool additive;
+            bool visible;
+
+            bool hasValue;
+            int value;
+        };
+
+        std::vector<Widget> widgets;
+        RenderTexture2D target = {};
+        int width = 0;
+        int height = 0;
+        bool dirty = true;
+
+        void layout(Widget& widget);
+        void drawWidget(const Widget& widget) const;
+};
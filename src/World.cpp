@@ -0,0 +1,340 @@
+#include "World.hpp"
+
+#include "../libs/raylib/src/raymath.h"
+
+#include <algorithm>
+
+static const float SchedulerTickLength = 1.0f / 120;
+static const int SchedulerCapacity = 1024;
+static const float ShipCollisionRadius = 0.5f;
+static const float BulletSpeed = 100;
+
+// Seconds between an enemy's shots, give or take a quarter so they don't fire in step.
+static const float EnemyFireInterval = 0.8f;
+static const Color EnemyBulletColor = ORANGE;
+
+// Whether the path something took this tick passes within `radius` of `center`.
+static bool segmentHitsSphere(Vector3 from, Vector3 to, Vector3 center, float radius) {
+    Vector3 segment = Vector3Subtract(to, from);
+    float lengthSqr = Vector3LengthSqr(segment);
+    float t = 0;
+    if (lengthSqr > 1e-12f)
+        t = Clamp(Vector3DotProduct(Vector3Subtract(center, from), segment) / lengthSqr, 0, 1);
+    return Vector3DistanceSqr(Vector3Add(from, Vector3Scale(segment, t)), center) < radius * radius;
+}
+
+static void spawnEnemy(void* data) {
+    auto world = static_cast<World*>(data);
+    if (world->enemies.size() < 4) {
+        world->summonEnemy();
+    }
+}
+
+World::World(Model shipModel, Model asteroidModel, uint64_t seed)
+    : player(shipModel, false), field(asteroidModel, seed), scheduler(SchedulerCapacity, SchedulerTickLength), random(seed),
+      gunnery(maxEnemies) {
+    this->shipModel = shipModel;
+    this->asteroidModel = asteroidModel;
+
+    // Built once here and shared by every asteroid, since they all use the same mesh.
+    if (asteroidModel.meshCount > 0)
+        asteroidBvh.reset(new MeshBvh(asteroidModel.meshes[0]));
+
+    scheduler.schedulePeriodic(5, 5, spawnEnemy, this);
+
+    // Room for more than normal play needs, so the frame loop doesn't allocate.
+    enemies.reserve(maxEnemies);
+    bullets.reserve(maxBullets);
+    asteroids.reserve(maxAsteroids);
+    explosions.reserve(64);
+
+    gunnery.bulletSpeed = BulletSpeed;
+
+    gunTimers.resize(SchedulerCapacity);
+    freeGunTimers.reserve(SchedulerCapacity);
+    for (int i = SchedulerCapacity - 1; i >= 0; --i) {
+        gunTimers[i].world = this;
+        gunTimers[i].enemyId = 0;
+        freeGunTimers.push_back(i);
+    }
+}
+
+void World::summonEnemy() {
+    Ship other(player);
+    Vector3 direction;
+    direction.x = random.range(-10, 10);
+    direction.y = random.range(-10, 10);
+    direction.z = random.range(-10, 10);
+    direction = Vector3Normalize(direction);
+    other.position = Vector3Add(player.position, Vector3Scale(direction, 15));
+    other.trailColor = MAROON;
+    other.isEnemy = true;
+    other.id = nextEnemyId++;
+    scheduleGunReady(other, EnemyFireInterval);
+    enemies.push_back(other);
+}
+
+void World::summonAsteroid() {
+    Vector3 position = Vector3Add(player.position, Vector3Scale(player.getForward(), 40));
+    Vector3 velocity = Vector3Scale(player.getForward(), 20);
+    Vector3 rotation;
+    rotation.x = random.range(1, 7);
+    rotation.y = random.range(1, 7);
+    rotation.z = random.range(1, 7);
+    int shapeSeed = random.range(0, AsteroidShapeSeeds - 1);
+    asteroids.push_back(Asteroid(asteroidModel, position, velocity, rotation, shapeSeed));
+}
+
+void World::fireBullet() {
+    bullets.push_back(Bullet(false, RED, player.position, Vector3Scale(player.getForward(), BulletSpeed)));
+}
+
+void World::update(float deltaTime) {
+    tick++;
+    collisionTests = 0;
+    explosions.clear();
+    field.resetTestCount();
+
+    scheduler.advance(deltaTime);
+    field.update(player.position);
+
+    player.update(deltaTime);
+
+    // Remove dead bullets
+    bullets.erase(std::remove_if(bullets.begin(),
+                bullets.end(),
+                [&](Bullet& bullet) {
+                return bullet.isDead;
+                }),
+            bullets.end());
+
+    // Remove dead enemies
+    enemies.erase(std::remove_if(enemies.begin(),
+                  enemies.end(),
+                  [&](Ship& enemy) {
+                    return enemy.isDead;
+                  }),
+            enemies.end());
+
+    // Remove dead asteroids
+    asteroids.erase(std::remove_if(asteroids.begin(),
+                    asteroids.end(),
+                    [&](Asteroid& asteroid) {
+                        return asteroid.isDead;
+                    }),
+                    asteroids.end());
+
+    // Update bullets. They're tested along the whole path they took this tick, so fast ones
+    // can't skip through ships or thin parts of an asteroid. Enemy bullets hit the player, the
+    // player's hit enemies.
+    for (auto &bullet : bullets) {
+        Vector3 from = bullet.position;
+        bullet.update(deltaTime);
+        collisionTests += (int)((bullet.isEnemy ? 1 : enemies.size()) + asteroids.size());
+
+        if (bullet.isEnemy) {
+            if (!player.isDead && segmentHitsSphere(from, bullet.position, player.position, ShipCollisionRadius)) {
+                bullet.isDead = true;
+                player.isDead = true;
+                explode(ExplosionType::SHIP, player.position, player.velocity, ShipCollisionRadius);
+            }
+        } else {
+            for (auto &enemy : enemies) {
+                if (!enemy.isDead && segmentHitsSphere(from, bullet.position, enemy.position, ShipCollisionRadius)) {
+                    bullet.isDead = true;
+                    enemy.isDead = true;
+                    explode(ExplosionType::SHIP, enemy.position, enemy.velocity, ShipCollisionRadius);
+                }
+            }
+        }
+
+        for (auto &asteroid : asteroids) {
+            if (!asteroid.isDead && asteroid.isHitBySegment(asteroidBvh.get(), from, bullet.position)) {
+                bullet.isDead = true;
+                asteroid.isDead = true;
+                explode(ExplosionType::ASTEROID, asteroid.position, asteroid.velocity, asteroid.getCollisionRadius());
+            }
+        }
+
+        Asteroid hitAsteroid;
+        if (field.destroyHitBy(asteroidBvh.get(), from, bullet.position, &hitAsteroid)) {
+            bullet.isDead = true;
+            explode(ExplosionType::ASTEROID, hitAsteroid.position, hitAsteroid.velocity, hitAsteroid.getCollisionRadius());
+        }
+    }
+
+    // Update asteroids
+    for (auto &asteroid : asteroids) {
+        asteroid.update(deltaTime);
+
+        if (Vector3Distance(asteroid.position, player.position) > 50) {
+            asteroid.isDead = true;
+        }
+    }
+
+    // Update enemy
+    for (auto &enemy : enemies) {
+        enemy.update(deltaTime);
+    }
+    fireEnemyGuns();
+
+    // Ships crashing into asteroids
+    if (!player.isDead && hitsAsteroid(player.position, ShipCollisionRadius)) {
+        player.isDead = true;
+        explode(ExplosionType::SHIP, player.position, player.velocity, ShipCollisionRadius);
+    }
+    for (auto &enemy : enemies) {
+        if (!enemy.isDead && hitsAsteroid(enemy.position, ShipCollisionRadius)) {
+            enemy.isDead = true;
+            explode(ExplosionType::SHIP, enemy.position, enemy.velocity, ShipCollisionRadius);
+        }
+    }
+    collisionTests += (int)((enemies.size() + 1) * asteroids.size()) + field.getTestCount();
+}
+
+void World::explode(ExplosionType type, Vector3 position, Vector3 velocity, float radius) {
+    Explosion explosion;
+    explosion.type = type;
+    explosion.position = position;
+    explosion.velocity = velocity;
+    explosion.radius = radius;
+    explosions.push_back(explosion);
+}
+
+void World::fireEnemyGuns() {
+    if (player.isDead || enemies.empty())
+        return;
+
+    // Aiming is solved for every enemy in one batch. Only the ones that are ready and have a
+    // shot fire.
+    gunnery.aim(enemies, player);
+    for (int i = 0; i < (int)enemies.size(); ++i) {
+        Ship& enemy = enemies[i];
+        if (enemy.isDead)
+            continue;
+
+        if (enemy.gunState == GunState::UNSCHEDULED) {
+            scheduleGunReady(enemy, EnemyFireInterval);
+            continue;
+        }
+
+        if (enemy.gunState != GunState::READY || !gunnery.hasShot(i))
+            continue;
+
+        bullets.push_back(Bullet(true, EnemyBulletColor, enemy.position, gunnery.getBulletVelocity(i)));
+        scheduleGunReady(enemy, EnemyFireInterval * random.range(75, 125) / 100.0f);
+    }
+}
+
+void World::scheduleGunReady(Ship& enemy, float delay) {
+    // Stays unscheduled if the scheduler is full, and fireEnemyGuns() tries again next tick.
+    enemy.gunState = GunState::UNSCHEDULED;
+    if (freeGunTimers.empty())
+        return;
+
+    GunTimer& timer = gunTimers[freeGunTimers.back()];
+    if (!scheduler.schedule(delay, readyGun, &timer).isValid())
+        return;
+
+    freeGunTimers.pop_back();
+    timer.enemyId = enemy.id;
+    enemy.gunState = GunState::COOLING;
+}
+
+void World::readyGun(void* data) {
+    auto timer = static_cast<GunTimer*>(data);
+    World* world = timer->world;
+
+    // Ids are handed out in order and removing enemies keeps the order, so the list is sorted
+    // by id.
+    auto enemy = std::lower_bound(world->enemies.begin(), world->enemies.end(), timer->enemyId,
+                                  [](const Ship& ship, uint32_t id) { return ship.id < id; });
+    if (enemy != world->enemies.end() && enemy->id == timer->enemyId)
+        enemy->gunState = GunState::READY;
+
+    timer->enemyId = 0;
+    world->freeGunTimers.push_back((int32_t)(timer - world->gunTimers.data()));
+}
+
+bool World::hitsAsteroid(Vector3 center, float radius) const {
+    for (auto &asteroid : asteroids) {
+        if (asteroid.isHitBySphere(asteroidBvh.get(), center, radius))
+            return true;
+    }
+
+    return field.isHitBySphere(asteroidBvh.get(), center, radius);
+}
+
+void World::saveState(StateWriter& writer) const {
+    writer.write(tick);
+    writer.write(random.state);
+    scheduler.saveState(writer);
+    writer.write(nextEnemyId);
+    writer.write((uint16_t)(gunTimers.size() - freeGunTimers.size()));
+    for (int i = 0; i < (int)gunTimers.size(); ++i) {
+        if (gunTimers[i].enemyId != 0) {
+            writer.write((uint16_t)i);
+            writer.write(gunTimers[i].enemyId);
+        }
+    }
+
+    player.saveState(writer);
+
+    writer.write((uint16_t)enemies.size());
+    for (auto &enemy : enemies)
+        enemy.saveState(writer);
+
+    writer.write((uint16_t)bullets.size());
+    for (auto &bullet : bullets)
+        bullet.saveState(writer);
+
+    writer.write((uint16_t)asteroids.size());
+    for (auto &asteroid : asteroids)
+        asteroid.saveState(writer);
+
+    field.saveState(writer);
+}
+
+void World::loadState(StateReader& reader) {
+    reader.read(tick);
+    reader.read(random.state);
+    scheduler.loadState(reader);
+    reader.read(nextEnemyId);
+    for (auto &timer : gunTimers)
+        timer.enemyId = 0;
+    uint16_t timerCount = 0;
+    reader.read(timerCount);
+    for (int i = 0; i < timerCount; ++i) {
+        uint16_t index = 0;
+        reader.read(index);
+        reader.read(gunTimers[index].enemyId);
+    }
+    freeGunTimers.clear();
+    for (int i = (int)gunTimers.size() - 1; i >= 0; --i) {
+        if (gunTimers[i].enemyId == 0)
+            freeGunTimers.push_back(i);
+    }
+
+    player.loadState(reader);
+
+    // Vectors keep their capacity, so after the first few loads this doesn't allocate.
+    uint16_t count = 0;
+    reader.read(count);
+    enemies.resize(count, Ship(shipModel, true));
+    for (auto &enemy : enemies)
+        enemy.loadState(reader);
+
+    count = 0;
+    reader.read(count);
+    bullets.resize(count, Bullet(false, RED, Vector3Zero(), Vector3Zero()));
+    for (auto &bullet : bullets)
+        bullet.loadState(reader);
+
+    count = 0;
+    reader.read(count);
+    asteroids.resize(count, Asteroid(asteroidModel, Vector3Zero(), Vector3Zero(), Vector3Zero(), 0));
+    for (auto &asteroid : asteroids)
+        asteroid.loadState(reader);
+
+    field.loadState(reader);
+}
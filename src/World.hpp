@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../libs/raylib/src/raylib.h"
+
+#include "Ship.hpp"
+#include "Bullet.hpp"
+#include "Asteroid.hpp"
+#include "Scheduler.hpp"
+#include "AsteroidField.hpp"
+#include "MeshBvh.hpp"
+#include "Random.hpp"
+#include "State.hpp"
+#include "EnemyGunnery.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+enum class ExplosionType { SHIP, ASTEROID };
+
+// Something that was destroyed, for effects.
+struct Explosion {
+    ExplosionType type;
+    Vector3 position;
+    Vector3 velocity;
+    float radius;
+};
+
+// Everything the gameplay simulation needs to advance a tick. All of it can be saved to and
+// restored from a few kilobytes, which is what rewind and instant retry are built on.
+class World {
+    public:
+        // What normal play stays under. Room for this many is reserved up front so the frame loop
+        // doesn't allocate, and the renderer's queue is sized from them. More still work.
+        static const int maxEnemies = 16;
+        static const int maxBullets = 256;
+        static const int maxAsteroids = 64;
+
+        uint32_t tick = 0;
+
+        Ship player;
+        std::vector<Ship> enemies;
+        std::vector<Bullet> bullets;
+        std::vector<Asteroid> asteroids;
+        AsteroidField field;
+
+        // Collision tests the last update made, for metrics.
+        int collisionTests = 0;
+
+        // What the last update destroyed. Not part of the saved state.
+        std::vector<Explosion> explosions;
+
+        // Timed gameplay events. Callbacks get the world, or something inside it, as their data,
+        // so saved state can only be loaded back into the same world.
+        Scheduler scheduler;
+        Random random;
+
+        World(Model shipModel, Model asteroidModel, uint64_t seed);
+
+        void summonEnemy();
+        void summonAsteroid();
+        void fireBullet();
+
+        // Whether a sphere touches any asteroid, in the field or not.
+        bool hitsAsteroid(Vector3 center, float radius) const;
+
+        // Input has to be applied to the ships before this is called. Ships that fly into an
+        // asteroid or are shot are marked dead, the player included. Enemies shoot at the player
+        // on their own.
+        void update(float deltaTime);
+
+        void saveState(StateWriter& writer) const;
+        void loadState(StateReader& reader);
+
+    private:
+        void explode(ExplosionType type, Vector3 position, Vector3 velocity, float radius);
+        void fireEnemyGuns();
+        void scheduleGunReady(Ship& enemy, float delay);
+        static void readyGun(void* data);
+
+        // Render resources given to new entities, including ones recreated when loading.
+        Model shipModel;
+        Model asteroidModel;
+
+        // For precise hits on asteroids. Null if the model has no mesh.
+        std::unique_ptr<MeshBvh> asteroidBvh;
+
+        // Scratch space for aiming, refilled every tick.
+        EnemyGunnery gunnery;
+
+        // A pending one-shot event that lets an enemy fire again. It finds the enemy by id when it
+        // fires, and does nothing if that enemy is gone by then. There's one per scheduler timer,
+        // so running out of these means the scheduler is full too.
+        struct GunTimer {
+            World* world;
+            uint32_t enemyId;
+        };
+        std::vector<GunTimer> gunTimers;
+        std::vector<int32_t> freeGunTimers;
+        uint32_t nextEnemyId = 1;
+};
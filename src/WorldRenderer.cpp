@@ -0,0 +1,213 @@
+#include "WorldRenderer.hpp"
+
+#include "../libs/raylib/src/raymath.h"
+
+#include "World.hpp"
+#include "GameCamera.hpp"
+#include "Skybox.hpp"
+#include "SpaceDust.hpp"
+#include "UILayer.hpp"
+#include "ParticleSystem.hpp"
+
+#include <algorithm>
+
+struct EnemyArrow {
+    Vector3 start;
+    Vector3 end;
+};
+
+struct DustView {
+    const SpaceDust* dust;
+    Vector3 viewPosition;
+    Vector3 velocity;
+};
+
+// The field loads all around the player, but only what's in front of a camera is drawn.
+struct ViewFront {
+    Vector3 position;
+    Vector3 forward;
+    float forwardLength;
+};
+
+static ViewFront getViewFront(const GameCamera& camera) {
+    ViewFront front;
+    front.position = camera.getPosition();
+    front.forward = Vector3Subtract(camera.camera.target, front.position);
+    front.forwardLength = Vector3Length(front.forward);
+    return front;
+}
+
+static bool isInFront(const ViewFront& front, const Asteroid& asteroid) {
+    Vector3 offset = Vector3Subtract(asteroid.position, front.position);
+    return Vector3DotProduct(offset, front.forward) >= -asteroid.scale * front.forwardLength;
+}
+
+static bool visibleOnScreen(Vector3 position, Camera camera, int width, int height) {
+    Vector2 positionOnScreen = GetWorldToScreenEx(position, camera, width, height);
+
+    Rectangle screenRect;
+    screenRect.x = 0;
+    screenRect.y = 0;
+    screenRect.width = width;
+    screenRect.height = height;
+
+    return CheckCollisionPointRec(positionOnScreen, screenRect);
+}
+
+SharedWorld prepareWorld(FrameArena& arena, const World& world, const WorldView* views, int viewCount) {
+    viewCount = std::min(viewCount, MaxViews);
+
+    SharedWorld shared;
+    shared.viewCount = viewCount;
+
+    ViewFront fronts[MaxViews];
+    for (int i = 0; i < viewCount; ++i)
+        fronts[i] = getViewFront(*views[i].camera);
+
+    shared.fieldAsteroids = FrameList<const Asteroid*>(arena, world.field.getMaxAsteroidCount());
+    world.field.forEachAsteroid([&](const Asteroid& asteroid) {
+        for (int i = 0; i < viewCount; ++i) {
+            if (isInFront(fronts[i], asteroid)) {
+                shared.fieldAsteroids.push(&asteroid);
+                return;
+            }
+        }
+    });
+
+    int enemyCount = (int)world.enemies.size();
+    shared.trailLines = FrameList<TrailLine>(arena, enemyCount * Ship::maxTrailLines);
+    shared.trailTriangles = FrameList<TrailTriangle>(arena, enemyCount * Ship::maxTrailTriangles);
+    for (auto &enemy : world.enemies)
+        enemy.buildTrail(shared.trailLines, shared.trailTriangles);
+
+    return shared;
+}
+
+void submitWorld(RenderQueue& queue, FrameArena& arena, const World& world, const SharedWorld& shared,
+                 const WorldView& view) {
+    const GameCamera& camera = *view.camera;
+    const Ship& ship = *view.ship;
+    Vector3 viewPosition = camera.getPosition();
+
+    queue.submit(RenderPass::OPAQUE_PASS, RenderMaterial::SHIP, world.player.position,
+                 [](const void* data) { static_cast<const Ship*>(data)->draw(false); },
+                 &world.player);
+
+    for (auto &bullet : world.bullets) {
+        queue.submit(RenderPass::OPAQUE_PASS, RenderMaterial::BULLET, bullet.position,
+                     [](const void* data) { static_cast<const Bullet*>(data)->draw(); },
+                     &bullet);
+    }
+
+    for (auto &asteroid : world.asteroids) {
+        queue.submit(RenderPass::OPAQUE_PASS, RenderMaterial::ASTEROID, asteroid.position,
+                     [](const void* data) { static_cast<const Asteroid*>(data)->draw(); },
+                     &asteroid);
+    }
+
+    // With one view, the shared list was already culled against it.
+    ViewFront front = getViewFront(camera);
+    for (const Asteroid* asteroid : shared.fieldAsteroids) {
+        if (shared.viewCount > 1 && !isInFront(front, *asteroid))
+            continue;
+
+        queue.submit(RenderPass::OPAQUE_PASS, RenderMaterial::ASTEROID, asteroid->position,
+                     [](const void* data) { static_cast<const Asteroid*>(data)->draw(); },
+                     asteroid);
+    }
+
+    // Enemies, their trails, and arrows pointing at the ones that are off screen
+    if (shared.trailLines.size() > 0 || shared.trailTriangles.size() > 0) {
+        queue.submit(RenderPass::ADDITIVE_PASS, RenderMaterial::TRAIL, viewPosition,
+                     [](const void* data) {
+                         auto shared = static_cast<const SharedWorld*>(data);
+                         drawTrails(shared->trailLines, shared->trailTriangles);
+                     },
+                     &shared);
+    }
+
+    FrameList<EnemyArrow> enemyArrows(arena, (int)world.enemies.size());
+    for (auto &enemy : world.enemies) {
+        queue.submit(RenderPass::OPAQUE_PASS, RenderMaterial::SHIP, enemy.position,
+                     [](const void* data) { static_cast<const Ship*>(data)->draw(false); },
+                     &enemy);
+
+        if (!visibleOnScreen(enemy.position, camera.camera, view.width, view.height)) {
+            Vector3 pointer = Vector3Subtract(ship.position, enemy.position);
+            pointer = Vector3Normalize(pointer);
+            EnemyArrow arrow;
+            arrow.start = Vector3Add(ship.position, Vector3Scale(pointer, -0.5));
+            arrow.end = Vector3Add(ship.position, Vector3Scale(pointer, -0.7));
+            enemyArrows.push(arrow);
+        }
+    }
+
+    for (auto &arrow : enemyArrows) {
+        queue.submit(RenderPass::OPAQUE_PASS, RenderMaterial::ENEMY_ARROW, arrow.start,
+                     [](const void* data) {
+                         auto arrow = static_cast<const EnemyArrow*>(data);
+                         DrawCylinderWiresEx(arrow->start, arrow->end, 0.07, 0, 10, RED);
+                     },
+                     &arrow);
+    }
+
+    if (view.skybox) {
+        queue.submit(RenderPass::SKYBOX_PASS, RenderMaterial::SKYBOX, viewPosition,
+                     [](const void* data) { static_cast<const Skybox*>(data)->draw(); },
+                     view.skybox);
+    }
+
+    if (view.crosshairFar) {
+        queue.submit(RenderPass::NO_DEPTH_PASS, RenderMaterial::CROSSHAIR, ship.position,
+                     [](const void* data) { static_cast<const Crosshair*>(data)->drawCrosshair(); },
+                     view.crosshairFar);
+    }
+    if (view.crosshairNear) {
+        queue.submit(RenderPass::NO_DEPTH_PASS, RenderMaterial::CROSSHAIR, ship.position,
+                     [](const void* data) { static_cast<const Crosshair*>(data)->drawCrosshair(); },
+                     view.crosshairNear);
+    }
+
+    if (view.particles) {
+        queue.submit(RenderPass::ADDITIVE_PASS, RenderMaterial::PARTICLES, viewPosition,
+                     [](const void* data) { static_cast<const ParticleSystem*>(data)->draw(); },
+                     view.particles);
+    }
+
+    DustView* dustView = view.dust ? arena.allocateArray<DustView>(1) : nullptr;
+    if (dustView) {
+        *dustView = { view.dust, viewPosition, ship.velocity };
+        queue.submit(RenderPass::ADDITIVE_PASS, RenderMaterial::DUST, viewPosition,
+                     [](const void* data) {
+                         auto view = static_cast<const DustView*>(data);
+                         view->dust->draw(view->viewPosition, view->velocity, false);
+                     },
+                     dustView);
+    }
+
+    if (view.ui) {
+        queue.submit(RenderPass::UI_PASS, RenderMaterial::HUD, { 0, 0, 0 },
+                     [](const void* data) { static_cast<const UILayer*>(data)->draw(); },
+                     view.ui);
+    }
+}
+
+int getMaxRenderItems(const World& world) {
+    // Player, trails, skybox, two crosshairs, particles, dust and the HUD.
+    const int fixedItems = 8;
+    // Every enemy is a ship and maybe an arrow.
+    return world.field.getMaxAsteroidCount() + World::maxAsteroids + World::maxBullets + World::maxEnemies * 2
+        + fixedItems;
+}
+
+Rectangle getSplitViewport(int index, int count, int width, int height) {
+    if (count <= 1)
+        return { 0, 0, (float)width, (float)height };
+
+    float halfWidth = (float)(width / 2);
+    float halfHeight = (float)(height / 2);
+    if (count == 2)
+        return { 0, index * halfHeight, (float)width, halfHeight };
+
+    return { (index % 2) * halfWidth, (index / 2) * halfHeight, halfWidth, halfHeight };
+}
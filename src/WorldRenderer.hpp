@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../libs/raylib/src/raylib.h"
+
+#include "RenderQueue.hpp"
+#include "FrameArena.hpp"
+#include "Ship.hpp"
+
+class World;
+class Asteroid;
+class Crosshair;
+class GameCamera;
+class Skybox;
+class SpaceDust;
+class UILayer;
+class ParticleSystem;
+
+// What a view of the world draws besides the world itself. Any of the pointers but the camera
+// and the ship can be null to leave that part out.
+struct WorldView {
+    const GameCamera* camera = nullptr;
+    // The ship the view follows. Off screen enemies get arrows around it, and dust streaks with
+    // its velocity.
+    const Ship* ship = nullptr;
+    const Crosshair* crosshairFar = nullptr;
+    const Crosshair* crosshairNear = nullptr;
+    const Skybox* skybox = nullptr;
+    const SpaceDust* dust = nullptr;
+    const ParticleSystem* particles = nullptr;
+    const UILayer* ui = nullptr;
+    // Size of the view's part of the render target, for telling what's on screen.
+    int width = 0;
+    int height = 0;
+};
+
+// Split screen goes up to four views.
+static const int MaxViews = 4;
+
+// Work every view of a frame shares, so an extra view only costs its own cull and submission.
+struct SharedWorld {
+    // Field asteroids in front of at least one of the views.
+    FrameList<const Asteroid*> fieldAsteroids;
+    // Every enemy's trail.
+    FrameList<TrailLine> trailLines;
+    FrameList<TrailTriangle> trailTriangles;
+    int viewCount = 0;
+};
+
+// Builds what the frame's views share, once, after the world and cameras have moved. Lists are
+// allocated from `arena`. Only the first MaxViews views are used.
+SharedWorld prepareWorld(FrameArena& arena, const World& world, const WorldView* views, int viewCount);
+
+// Submits a frame's draws of `world` seen through `view`, which has to be one of the views
+// `shared` was prepared for. Call between the queue's begin() and execute(). Per-frame data the
+// draws need is allocated from `arena`, and with `shared` it has to live until the queue is
+// executed.
+void submitWorld(RenderQueue& queue, FrameArena& arena, const World& world, const SharedWorld& shared,
+                 const WorldView& view);
+
+// The most items submitWorld() submits for one view while `world` is within its limits.
+int getMaxRenderItems(const World& world);
+
+// Where view `index` of `count` goes in a `width` by `height` render target: all of it, halves
+// one above the other, or quarters.
+Rectangle getSplitViewport(int index, int count, int width, int height);
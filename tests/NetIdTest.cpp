@@ -0,0 +1,141 @@
+// Runs entity ids through several wraps of the 16-bit id space the way the server spends them: a
+// few long-lived ships hold on to their ids while bullets and asteroids churn through fresh ones.
+// No id may be handed out while something still holds it, and snapshot deltas across the wrap
+// have to rebuild the same snapshot on the other end. Exits with 1 on the first failure.
+
+#include "../src/NetProtocol.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+static const int ShipCount = 8;
+static const int Wraps = 3;
+// Bullets live a second at 30 ticks a second, and 8 ships fire every 0.2 seconds.
+static const int BulletLifetime = 30;
+static const int BulletsPerTick = 2;
+
+static bool fail(const char* message, int tick) {
+    printf("FAIL at tick %d: %s\n", tick, message);
+    return false;
+}
+
+static void addEntity(NetSnapshot& snapshot, uint16_t id, NetEntityType type, uint32_t tick) {
+    NetEntity entity;
+    entity.id = id;
+    entity.type = type;
+    entity.spawnTick = tick;
+    snapshot.entities.push_back(entity);
+}
+
+static bool run() {
+    NetIdAllocator ids;
+    std::vector<uint16_t> ships;
+    std::vector<std::pair<uint16_t, int>> bullets;
+    std::vector<bool> held(65536, false);
+
+    for (int i = 0; i < ShipCount; ++i) {
+        uint16_t id = ids.allocate();
+        ships.push_back(id);
+        held[id] = true;
+    }
+
+    NetSnapshot baseline;
+    NetSnapshot received;
+    uint8_t packet[NetMaxPacketSize];
+    uint16_t lastId = 0;
+    int wraps = 0;
+    int tick = 0;
+
+    while (wraps < Wraps) {
+        tick++;
+
+        for (int i = 0; i < BulletsPerTick; ++i) {
+            uint16_t id = ids.allocate();
+            if (id == 0)
+                return fail("ran out of ids", tick);
+            if (held[id])
+                return fail("handed out an id that is still held", tick);
+
+            if (id < lastId)
+                wraps++;
+            lastId = id;
+
+            held[id] = true;
+            bullets.push_back(std::make_pair(id, tick));
+        }
+
+        for (auto& bullet : bullets) {
+            if (tick - bullet.second >= BulletLifetime) {
+                ids.release(bullet.first);
+                held[bullet.first] = false;
+            }
+        }
+        bullets.erase(std::remove_if(bullets.begin(), bullets.end(), [&](const std::pair<uint16_t, int>& bullet) {
+            return !held[bullet.first];
+        }), bullets.end());
+
+        if (ids.getUsedCount() != ShipCount + (int)bullets.size())
+            return fail("used count doesn't match what is held", tick);
+
+        // Every few ticks, send the world as a delta against an older snapshot, like to a client
+        // that acknowledges late.
+        if (tick % 16 == 0) {
+            NetSnapshot current;
+            current.tick = tick;
+            for (uint16_t id : ships)
+                addEntity(current, id, NetEntityType::SHIP, 0);
+            for (auto& bullet : bullets)
+                addEntity(current, bullet.first, NetEntityType::BULLET, bullet.second);
+            std::sort(current.entities.begin(), current.entities.end(), [](const NetEntity& a, const NetEntity& b) {
+                return a.id < b.id;
+            });
+
+            BitWriter writer(packet, sizeof(packet));
+            writeSnapshotDelta(writer, baseline, current);
+            int size = writer.finish();
+            if (writer.hasOverflowed())
+                return fail("delta overflowed the packet", tick);
+
+            BitReader reader(packet, size);
+            if (!readSnapshotDelta(reader, baseline, received))
+                return fail("delta didn't fit its baseline", tick);
+            if (received.entities.size() != current.entities.size()
+                || !std::equal(received.entities.begin(), received.entities.end(), current.entities.begin()))
+                return fail("delta rebuilt a different snapshot", tick);
+
+            baseline = current;
+        }
+    }
+
+    for (uint16_t id : ships) {
+        if (!ids.isUsed(id))
+            return fail("a ship lost its id", tick);
+    }
+
+    printf("%d wraps in %d ticks, no id handed out twice, deltas rebuilt every snapshot\n", wraps, tick);
+    return true;
+}
+
+// Filling every id and then freeing one has to give exactly that one back.
+static bool runFull() {
+    NetIdAllocator ids;
+    for (int i = 1; i < 65536; ++i) {
+        if (ids.allocate() == 0)
+            return fail("ran out of ids before all were used", i);
+    }
+    if (ids.allocate() != 0)
+        return fail("handed out an id with all of them in use", 0);
+
+    ids.release(12345);
+    if (ids.allocate() != 12345)
+        return fail("didn't hand back the only free id", 0);
+
+    printf("all 65535 ids used, the only free one handed back\n");
+    return true;
+}
+
+int main() {
+    bool passed = run() && runFull();
+    return passed ? 0 : 1;
+}